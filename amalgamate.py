@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""
+Amalgamation: one minified translation unit from many C sources
+
+Unity builds compile and link much faster downstream. Concatenating
+sources is not enough, so this mode also:
+1. Inlines local ("...") headers, once each when they are include-guarded
+   (#ifndef/#define/#endif or #pragma once); a system (<...>) include is
+   kept only at its first unconditional occurrence
+2. #undef's the macros each .c file defines at its end, as if the files
+   were still compiled apart; a macro a guarded header defined, which
+   later files no longer re-include, gets the header's definition back
+3. Renames static globals apart: every file's statics draw from one
+   global-scope counter, so they never share a short name, and one whose
+   name another file gives external linkage or a static function is
+   renamed outright
+4. Collapses a static function defined byte-identically in several files
+   into its first definition, when the minified copies agree too; a
+   static function whose name clashes otherwise is renamed
+
+Usage: python3 amalgamate.py [-o OUTPUT] [-I DIR]... <file.c>...
+"""
+
+import argparse
+import os
+import re
+import sys
+
+import minify
+
+# #include "x.h" / #include <x.h> on a line of its own
+INCLUDE = re.compile(rb'^[ \t]*#[ \t]*include[ \t]*([<"])([^>"\n]+)[>"][^\n]*\n?', re.M)
+DEFINE = re.compile(rb'^[ \t]*#[ \t]*define[ \t]+([A-Za-z_][A-Za-z0-9_]*)', re.M)
+# A whole #define directive, continuation lines included
+DEFINE_LINE = re.compile(
+    rb'^[ \t]*#[ \t]*define[ \t]+([A-Za-z_][A-Za-z0-9_]*)(?:[^\n\\]|\\.)*\n?', re.M | re.S)
+CONDITIONAL = re.compile(rb'^[ \t]*#[ \t]*(if|ifdef|ifndef|endif)\b', re.M)
+PRAGMA_ONCE = re.compile(rb'^[ \t]*#[ \t]*pragma[ \t]+once[^\n]*\n?', re.M)
+COMMENT = re.compile(rb'/\*.*?\*/|//[^\n]*', re.S)
+GUARD_OPEN = re.compile(rb'\A\s*#[ \t]*ifndef[ \t]+(\w+)\s*#[ \t]*define[ \t]+(\w+)')
+WORD = re.compile(rb'[A-Za-z_][A-Za-z0-9_]*')
+
+
+def is_guarded(text):
+    """True if including text a second time adds nothing"""
+    if PRAGMA_ONCE.search(text):
+        return True
+    code = COMMENT.sub(b' ', text)
+    match = GUARD_OPEN.match(code)
+    if not match or match.group(1) != match.group(2):
+        return False
+    # The #ifndef must close only at the very last directive of the file
+    depth = 0
+    closed = None
+    for conditional in CONDITIONAL.finditer(code):
+        if closed is not None:
+            return False
+        depth += -1 if conditional.group(1) == b'endif' else 1
+        if depth == 0:
+            closed = conditional.end()
+    return closed is not None and not code[closed:].partition(b'\n')[2].strip()
+
+
+class Amalgamator:
+    """Builds the combined source of several .c files, header by header"""
+    def __init__(self, include_dirs=()):
+        self.include_dirs = list(include_dirs)
+        self.done = set()  # guarded headers already inlined unconditionally
+        self.system = set()  # system includes already kept unconditionally
+        self.header_defines = {}  # macro -> its #define lines in the headers in done
+        self.inlined = 0
+        self.dropped = 0  # includes left out as already present
+
+    def resolve(self, name, including_dir):
+        for directory in [including_dir] + self.include_dirs:
+            path = os.path.join(directory, name.decode('utf-8', 'surrogateescape'))
+            if os.path.isfile(path):
+                return os.path.realpath(path)
+        return None
+
+    def expand(self, path, active=()):
+        """Text of path with its local includes inlined"""
+        with open(path, 'rb') as f:
+            text = f.read()
+        directory = os.path.dirname(path)
+        out = []
+        pos = 0
+        for match in INCLUDE.finditer(text):
+            out.append(text[pos:match.start()])
+            pos = match.end()
+            # Conditional nesting so far: only unconditional includes count
+            # as done, a later one might be the one that is compiled
+            depth = 0
+            for conditional in CONDITIONAL.finditer(text, 0, match.start()):
+                depth += -1 if conditional.group(1) == b'endif' else 1
+            kind, name = match.group(1), match.group(2).strip()
+            header = self.resolve(name, directory) if kind == b'"' else None
+            if header is None:
+                key = (kind, name)
+                if key in self.system:
+                    self.dropped += 1
+                    continue
+                if depth == 0:
+                    self.system.add(key)
+                out.append(match.group().rstrip(b'\n') + b'\n')
+                continue
+            if header in self.done or header in active:
+                self.dropped += 1
+                continue
+            contents = self.expand(header, active + (header,))
+            if is_guarded(contents) and depth == 0:
+                self.done.add(header)
+                for match in DEFINE_LINE.finditer(contents):
+                    self.header_defines.setdefault(match.group(1), []).append(
+                        match.group().rstrip(b'\n') + b'\n')
+            self.inlined += 1
+            out.append(PRAGMA_ONCE.sub(b'', contents).rstrip(b'\n') + b'\n')
+        out.append(text[pos:])
+        return b''.join(out)
+
+    def source(self, path):
+        """Expanded text of one .c file, undefining its own macros at the end"""
+        with open(path, 'rb') as f:
+            own = f.read()
+        text = self.expand(os.path.realpath(path)).rstrip(b'\n') + b'\n'
+        macros = sorted(set(DEFINE.findall(own)))
+        tail = []
+        for name in macros:
+            definitions = self.header_defines.get(name)
+            if definitions is None:
+                tail.append(b'#undef ' + name + b'\n')
+            elif len(definitions) == 1:
+                # Redefined over a header later files see only through
+                # this one: restore the header's value for them
+                tail.append(b'#undef ' + name + b'\n' + definitions[0])
+            # Several definitions depend on the header's conditionals,
+            # which are long evaluated: the file's own value is left
+        return text + b''.join(tail), macros
+
+
+def is_static(node, source_bytes):
+    return any(child.type == 'storage_class_specifier'
+               and source_bytes[child.start_byte:child.end_byte] == b'static'
+               for child in node.children)
+
+
+def declared_name(declarator, source_bytes):
+    """(name, declares a function) at the end of a declarator chain"""
+    is_function = False
+    while declarator is not None and declarator.type != 'identifier':
+        is_function |= declarator.type == 'function_declarator'
+        declarator = declarator.child_by_field_name('declarator')
+    if declarator is None:
+        return None, False
+    return source_bytes[declarator.start_byte:declarator.end_byte], is_function
+
+
+def file_statics(tree, source_bytes):
+    """({name: node} of static function definitions, static variable names)"""
+    functions = {}
+    variables = set()
+    for child in tree.root_node.children:
+        if not is_static(child, source_bytes):
+            continue
+        if child.type == 'function_definition':
+            name, _ = declared_name(child.child_by_field_name('declarator'), source_bytes)
+            if name is not None:
+                functions.setdefault(name, child)
+        elif child.type == 'declaration':
+            for declarator in child.children_by_field_name('declarator'):
+                name, is_function = declared_name(declarator, source_bytes)
+                if name is not None and not is_function:
+                    variables.add(name)
+    return functions, variables
+
+
+def node_text(source_bytes, node):
+    return source_bytes[node.start_byte:node.end_byte]
+
+
+def emit_node(minifier, node):
+    emitter = minify.TokenEmitter(minifier.source_bytes, minifier.replacements)
+    emitter.emit(node)
+    return emitter.getvalue()
+
+
+def amalgamate(paths, include_dirs=(), report=None):
+    """Minified bytes of the single translation unit made of paths
+
+    report, if a dict, receives counts of what was merged.
+    """
+    builder = Amalgamator(include_dirs)
+    parser = minify.get_parser()
+    texts = []
+    file_macros = set()
+    for path in paths:
+        text, macros = builder.source(path)
+        texts.append(text)
+        file_macros.update(macros)
+    trees = [parser.parse(text) for text in texts]
+    statics, static_variables = zip(*(file_statics(tree, text) for tree, text in zip(trees, texts)))
+    static_functions = set().union(*statics)
+
+    words = set()
+    for text in texts:
+        words.update(WORD.findall(text))
+    fresh = minify.NameSequence(minify.KEYWORDS | words)
+
+    # Static functions of later files: collapsed into an identical earlier
+    # one, or renamed when their name is taken by another definition.
+    # Each round can only move a name from kept to collapsed to renamed,
+    # so this settles.
+    renames = [{} for _ in paths]
+    collapsed = [set() for _ in paths]  # names whose definition is dropped
+    while True:
+        minifiers = build(texts, trees, renames)
+        external = set()  # names with external linkage somewhere
+        for m, own in zip(minifiers, statics):
+            external |= (m.function_names | m.global_names) - own.keys()
+        first = {}  # static function name -> (file index, kept node)
+        changed = False
+        for i, m in enumerate(minifiers):
+            # Static variables get short names anyway, unless their name is
+            # reserved because another file gives it external linkage or
+            # defines a static function of that name
+            for name in static_variables[i] & (external | static_functions):
+                if name not in renames[i]:
+                    renames[i][name] = fresh[sum(len(r) for r in renames)]
+                    changed = True
+            for name, node in statics[i].items():
+                if name in renames[i]:
+                    continue
+                if name not in first and name not in external:
+                    first[name] = (i, node)
+                    continue
+                if name in first:
+                    j, kept = first[name]
+                    if name in collapsed[i]:
+                        # Confirm on the renamed, minified tokens
+                        if emit_node(m, node) == emit_node(minifiers[j], kept):
+                            continue
+                        collapsed[i].discard(name)
+                    elif (node_text(texts[i], node) == node_text(texts[j], kept)
+                          and not file_macros & set(WORD.findall(node_text(texts[i], node)))):
+                        collapsed[i].add(name)
+                        changed = True
+                        continue
+                renames[i][name] = fresh[sum(len(r) for r in renames)]
+                changed = True
+        if not changed:
+            break
+
+    outputs = []
+    for i, m in enumerate(minifiers):
+        dropped = {statics[i][name].start_byte for name in collapsed[i]}
+        emitter = minify.TokenEmitter(m.source_bytes, m.replacements)
+        for child in m.tree.root_node.children:
+            if child.start_byte not in dropped:
+                emitter.emit(child)
+        emitter.finish()
+        outputs.append(emitter.getvalue())
+
+    if report is not None:
+        report.update({
+            'files': len(paths),
+            'headers_inlined': builder.inlined,
+            'includes_dropped': builder.dropped,
+            'statics_renamed': sum(len(r) for r in renames),
+            'functions_collapsed': sum(len(c) for c in collapsed),
+        })
+    # Every file ends at a line boundary, so a newline is always a safe seam
+    return b'\n'.join(output for output in outputs if output)
+
+
+def build(texts, trees, renames):
+    """Walk and resolve every file with one reserved set and static counter"""
+    minifiers = [minify.CMinifier(text, enable_renaming=True, tree=tree, project_names=r)
+                 for text, tree, r in zip(texts, trees, renames)]
+    reserved = set(minify.KEYWORDS)
+    for m in minifiers:
+        m.walk()
+        reserved |= m.function_names | m.global_names
+        reserved.update(m.project_names.values())
+    counter = 0
+    for m in minifiers:
+        # Statics continue where the previous file's left off
+        m.scopes[0].counter = counter
+        m.resolve_identifiers(reserved=reserved)
+        counter = m.scopes[0].counter
+    return minifiers
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description='Merge C sources into one minified translation unit')
+    parser.add_argument('files', nargs='+', help='.c files, in link order')
+    parser.add_argument('-o', '--output', default=None, help='write here instead of stdout')
+    parser.add_argument('-I', dest='include_dirs', action='append', default=[],
+                        help='directory searched for "..." includes')
+    args = parser.parse_args(argv)
+
+    report = {}
+    try:
+        output = amalgamate(args.files, args.include_dirs, report)
+    except OSError as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+    if args.output:
+        with open(args.output, 'wb') as f:
+            f.write(output + b'\n')
+    else:
+        sys.stdout.buffer.write(output + b'\n')
+    print(f"Amalgamated {report['files']} files: {report['headers_inlined']} headers inlined, "
+          f"{report['includes_dropped']} includes dropped, {report['statics_renamed']} statics "
+          f"renamed apart, {report['functions_collapsed']} functions collapsed", file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
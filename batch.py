@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+"""
+Batch mode for the C minifier
+
+Minifies whole source trees in one run:
+1. Expands directories, globs and @manifest files into a list of sources
+2. Minifies them on a process pool, one shared Parser per worker
+3. Mirrors every output into an output directory
+4. With --verify, checks every output against its source (see verify.py);
+   a file that diverges is written but counts as failed
+
+Usage: python3 batch.py -o <out_dir> [-j N] [--cache-dir DIR] [--stats [FILE]] [--verify]
+                       [--remove-dead-code] [--compact-literals] [--name-order ORDER]
+                       <dir|glob|@manifest|file.c>...
+"""
+
+import argparse
+import glob
+import os
+import sys
+import time
+from concurrent.futures import ProcessPoolExecutor
+
+import minify
+
+# File extensions picked up when a directory is given
+SOURCE_EXTENSIONS = ('.c', '.h')
+
+
+def expand_directory(path):
+    """All C sources under a directory, as (source_path, relative_path) pairs"""
+    found = []
+    for root, dirs, files in os.walk(path):
+        dirs.sort()
+        for name in sorted(files):
+            if name.endswith(SOURCE_EXTENSIONS):
+                full = os.path.join(root, name)
+                found.append((full, os.path.relpath(full, path)))
+    return found
+
+
+def relative_output_path(path):
+    """Mirror path for a file named directly: relative to cwd, or its basename"""
+    rel = os.path.relpath(path)
+    if rel.startswith(os.pardir) or os.path.isabs(rel):
+        return os.path.basename(path)
+    return rel
+
+
+def expand_inputs(inputs):
+    """Expand directories, globs and @manifest files into (source, relative) pairs
+
+    A manifest is a text file with one path, directory or glob per line;
+    blank lines and lines starting with '#' are ignored. Duplicates are
+    dropped, keeping the first occurrence. Two different sources that
+    mirror to the same relative path (e.g. files of the same name outside
+    the working directory) raise ValueError, before anything is written.
+    """
+    pending = list(inputs)
+    found = []
+    while pending:
+        item = pending.pop(0)
+        if item.startswith('@'):
+            with open(item[1:], 'r') as f:
+                lines = [line.strip() for line in f]
+            pending[0:0] = [line for line in lines if line and not line.startswith('#')]
+        elif os.path.isdir(item):
+            found.extend(expand_directory(item))
+        elif os.path.isfile(item):
+            found.append((item, relative_output_path(item)))
+        else:
+            matches = sorted(glob.glob(item, recursive=True))
+            if not matches:
+                raise FileNotFoundError(f"No input matches '{item}'")
+            for match in matches:
+                if os.path.isdir(match):
+                    found.extend(expand_directory(match))
+                else:
+                    found.append((match, relative_output_path(match)))
+
+    seen = set()
+    unique = []
+    outputs = {}  # normalized relative path -> the source writing it
+    for source, rel in found:
+        key = os.path.realpath(source)
+        if key in seen:
+            continue
+        seen.add(key)
+        output = os.path.normcase(os.path.normpath(rel))
+        if output in outputs:
+            raise ValueError(f"'{outputs[output]}' and '{source}' would both be written to '{rel}'")
+        outputs[output] = source
+        unique.append((source, rel))
+    return unique
+
+
+# Per-process result cache, set up by init_worker() when --cache-dir is given
+_cache = None
+# The stats module when --stats is given, else None
+_stats = None
+# The verify module when --verify is given, else None
+_verify = None
+# CMinifier pass options: remove_dead_code, compact_literals, name_order
+_passes = {}
+
+
+def init_worker(cache_dir=None, cache_max_bytes=None, collect_stats=False, verify=False,
+                passes=None):
+    """Pool initializer: build this worker's Language/Parser (and cache) once"""
+    global _cache, _stats, _verify, _passes
+    minify.get_parser()
+    _passes = passes or {}
+    if cache_dir:
+        import cache
+        _cache = cache.ResultCache(cache_dir, cache_max_bytes or cache.DEFAULT_MAX_BYTES)
+    if collect_stats:
+        import stats
+        _stats = stats
+    if verify:
+        import verify as verifier
+        _verify = verifier
+
+
+def minify_file(task):
+    """Minify one file and write its output; runs inside a worker"""
+    source_path, output_path = task
+    start = time.perf_counter()
+    in_bytes = out_bytes = 0
+    error = None
+    cached = False
+    report = None
+    divergence = None
+    passes = _passes
+    if passes.get('remove_dead_code') and source_path.endswith(minify.HEADER_EXTENSIONS):
+        # Dead code removal must keep the statics a header exists to provide
+        passes = dict(passes, header=True)
+    try:
+        source = minify.read_source(source_path)
+        os.makedirs(os.path.dirname(output_path) or '.', exist_ok=True)
+        with open(output_path, 'wb') as f:
+            if _stats is not None:
+                # Profiled run; a cache, if any, is still filled but not read
+                minified, report = _stats.profile(source, name=source_path,
+                                                  verify=_verify is not None, **passes)
+                divergence = report.get('divergence')
+                if _cache is not None:
+                    _cache.put(_cache.key(source, minify.ENABLE_RENAMING, **passes), minified)
+                f.write(minified)
+                out_bytes = len(minified)
+            elif _verify is not None:
+                # Every output is checked, so a cached one is not read either
+                minifier = minify.CMinifier(source, **passes)
+                minified = minifier.minify()
+                divergence = _verify.verify(minifier, minified)
+                if _cache is not None and divergence is None:
+                    _cache.put(_cache.key(source, minify.ENABLE_RENAMING, **passes), minified)
+                f.write(minified)
+                out_bytes = len(minified)
+            elif _cache is not None:
+                hits = _cache.hits
+                minified = _cache.minify(source, **passes)
+                cached = _cache.hits > hits
+                f.write(minified)
+                out_bytes = len(minified)
+            else:
+                # Stream straight into the output file
+                out_bytes = minify.CMinifier(source, **passes).minify_to(f)
+            f.write(b'\n')
+        in_bytes = len(source)
+        if divergence is not None:
+            error = f"output diverges: {_verify.format_divergence(source_path, divergence)}"
+    except Exception as e:
+        error = f"{type(e).__name__}: {e}"
+    return source_path, in_bytes, out_bytes, time.perf_counter() - start, error, cached, report
+
+
+def split_file(task, pool, jobs):
+    """Minify one large file across the whole pool (see parallel.py); runs in the parent"""
+    import parallel
+    source_path, output_path = task
+    start = time.perf_counter()
+    in_bytes = out_bytes = 0
+    error = None
+    try:
+        source = minify.read_source(source_path)
+        report = {}
+        minified = parallel.minify_parallel(source, jobs, pool=pool, report=report)
+        if report['fallback']:
+            print(f"{source_path}: minified sequentially: {report['fallback']}", file=sys.stderr)
+        os.makedirs(os.path.dirname(output_path) or '.', exist_ok=True)
+        with open(output_path, 'wb') as f:
+            f.write(minified)
+            f.write(b'\n')
+        in_bytes = len(source)
+        out_bytes = len(minified)
+    except Exception as e:
+        error = f"{type(e).__name__}: {e}"
+    return source_path, in_bytes, out_bytes, time.perf_counter() - start, error, False, None
+
+
+def schedule(tasks):
+    """Order tasks largest first so big files don't straggle at the end"""
+    return sorted(tasks, key=lambda task: (-os.path.getsize(task[0]), task[0]))
+
+
+def run_batch(inputs, output_dir, jobs=None, cache_dir=None, cache_max_bytes=None,
+              collect_stats=False, verify=False, passes=None):
+    """Minify every input into output_dir; returns results in input order
+
+    Each result is (source_path, input_bytes, output_bytes, seconds, error,
+    cached, stats report or None). With cache_dir set, workers share one
+    on-disk result cache; with collect_stats, every file is profiled; with
+    verify, a file whose output diverges from its source gets an error.
+    passes holds CMinifier's remove_dead_code, compact_literals and
+    name_order for every file.
+
+    Without any of these options, files of at least
+    parallel.MIN_PARALLEL_BYTES are each split across all workers before
+    the rest are minified one per worker. Outputs depend only on their own
+    source, so they are identical for any number of workers; only
+    completion order varies.
+    """
+    files = expand_inputs(inputs)
+    tasks = [(source, os.path.join(output_dir, rel)) for source, rel in files]
+
+    if jobs is None:
+        jobs = os.cpu_count() or 1
+    large = []
+    if jobs > 1 and not (cache_dir or collect_stats or verify or passes):
+        import parallel
+        large = [task for task in tasks if os.path.getsize(task[0]) >= parallel.MIN_PARALLEL_BYTES]
+    rest = [task for task in tasks if task not in large]
+    if not large:
+        jobs = max(1, min(jobs, len(tasks)))
+
+    by_source = {}
+    init_args = (cache_dir, cache_max_bytes, collect_stats, verify, passes)
+    if jobs == 1:
+        init_worker(*init_args)
+        for task in schedule(tasks):
+            result = minify_file(task)
+            by_source[result[0]] = result
+    else:
+        with ProcessPoolExecutor(max_workers=jobs, initializer=init_worker,
+                                 initargs=init_args) as pool:
+            for task in schedule(large):
+                result = split_file(task, pool, jobs)
+                by_source[result[0]] = result
+            for result in pool.map(minify_file, schedule(rest), chunksize=1):
+                by_source[result[0]] = result
+
+    return [by_source[source] for source, _ in tasks]
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        prog='minify.py', description='Minify many C files into an output directory')
+    parser.add_argument('inputs', nargs='+',
+                        help='source files, directories, globs or @manifest files')
+    parser.add_argument('-o', '--output-dir', required=True,
+                        help='directory that mirrors the minified inputs')
+    parser.add_argument('-j', '--jobs', type=int, default=None,
+                        help='worker processes (default: all cores)')
+    parser.add_argument('--cache-dir', default=None,
+                        help='reuse results from this shared on-disk cache')
+    parser.add_argument('--cache-size', type=int, default=None,
+                        help='cache size limit in bytes (default: 256 MiB)')
+    parser.add_argument('--stats', nargs='?', const='-', default=None, metavar='FILE',
+                        help='write a per-phase JSON report (default: stderr)')
+    parser.add_argument('--verify', action='store_true',
+                        help='check every output against its source')
+    parser.add_argument('--remove-dead-code', action='store_true',
+                        help='drop unreferenced statics and unused locals')
+    parser.add_argument('--compact-literals', action='store_true',
+                        help='fold constants and shorten literals')
+    parser.add_argument('--name-order', choices=minify.NAME_ORDERS, default='uses',
+                        help='which locals get the shortest names first (default: uses)')
+    args = parser.parse_args(argv)
+
+    passes = {}
+    if args.remove_dead_code:
+        passes['remove_dead_code'] = True
+    if args.compact_literals:
+        passes['compact_literals'] = True
+    if args.name_order != 'uses':
+        passes['name_order'] = args.name_order
+    try:
+        results = run_batch(args.inputs, args.output_dir, args.jobs,
+                            args.cache_dir, args.cache_size, args.stats is not None, args.verify,
+                            passes)
+    except (FileNotFoundError, OSError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    failed = 0
+    hits = 0
+    total_in = total_out = 0
+    for source, in_bytes, out_bytes, _, error, cached, _ in results:
+        if error:
+            failed += 1
+            print(f"FAILED {source}: {error}", file=sys.stderr)
+        else:
+            total_in += in_bytes
+            total_out += out_bytes
+            hits += cached
+
+    print(f"Minified {len(results) - failed}/{len(results)} files: "
+          f"{total_in} -> {total_out} bytes", file=sys.stderr)
+    if args.cache_dir:
+        print(f"Cache: {hits} hits, {len(results) - failed - hits} misses", file=sys.stderr)
+    if args.stats is not None:
+        import stats
+        total = stats.empty_report()
+        for result in results:
+            if result[6] is not None:
+                stats.merge(total, result[6])
+        stats.write_report(total, args.stats)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
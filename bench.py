@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+Performance benchmarks for the C minifier
+
+1. Generates synthetic C sources of a given size and shape
+2. Minifies each one in a fresh process, timing every phase
+3. Reports throughput, per-phase time and peak RSS as JSON
+
+Shapes:
+    functions   many small functions calling each other
+    nesting     deeply nested blocks and control flow
+    shadowing   the same names redeclared in nested scopes (cf. 06_collision.c)
+    arrays      huge static initializer arrays
+    comments    code buried in line and block comments
+    macros      object/function-like macros and conditional blocks
+    mixed       all of the above, interleaved
+
+Usage:
+    python3 bench.py generate --shape SHAPE --size SIZE [--seed N] -o FILE
+    python3 bench.py run [--shapes a,b] [--sizes 100K,1M] [--repeat N] [--json FILE]
+    python3 bench.py run --files a.c b.c ...
+"""
+
+import argparse
+import json
+import os
+import platform
+import random
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+import minify
+
+SHAPES = ('functions', 'nesting', 'shadowing', 'arrays', 'comments', 'macros', 'mixed')
+DEFAULT_SIZES = '100K,1M'
+# Version of the JSON report layout
+REPORT_FORMAT = 1
+
+
+def parse_size(text):
+    """'512', '100K', '2M' -> bytes"""
+    text = text.strip().upper()
+    scale = {'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}.get(text[-1:], 1)
+    return int(float(text[:-1] if scale > 1 else text) * scale)
+
+
+class CorpusGenerator:
+    """Writes valid, runnable C of a chosen shape; deterministic for a seed"""
+    def __init__(self, shape, seed=0):
+        if shape not in SHAPES:
+            raise ValueError(f"Unknown shape '{shape}'")
+        self.shape = shape
+        self.rng = random.Random(seed)
+        self.count = 0  # names generated so far
+        self.declared = []  # (function, arity) pairs main() calls
+        self.last_compute = None
+
+    def generate(self, size):
+        """Source of roughly size bytes, ending in a main() that returns 0"""
+        parts = ['#include <stdio.h>\n#include <string.h>\n\n']
+        total = len(parts[0])
+        shapes = SHAPES[:-1] if self.shape == 'mixed' else (self.shape,)
+        while total < size:
+            chunk = getattr(self, 'gen_' + self.rng.choice(shapes))()
+            parts.append(chunk)
+            total += len(chunk)
+        parts.append(self.gen_main())
+        return ''.join(parts)
+
+    def next_name(self, prefix):
+        self.count += 1
+        return f"{prefix}_{self.count}"
+
+    def gen_functions(self):
+        name = self.next_name('compute')
+        callee = self.last_compute if self.rng.random() < 0.5 else None
+        self.last_compute = name
+        body = [f"static int {name}(int left, int right)\n{{\n",
+                "    int total = left + right;\n",
+                "    int index;\n",
+                "    for (index = 0; index < 4; index++) {\n",
+                "        total = total * 3 + index - right;\n",
+                "    }\n"]
+        if callee:
+            body.append(f"    total += {callee}(right, left) & 7;\n")
+        body.append("    return total & 0xffff;\n}\n\n")
+        self.declared.append((name, 2))
+        return ''.join(body)
+
+    def gen_nesting(self):
+        name = self.next_name('nested')
+        depth = self.rng.randint(8, 24)
+        lines = [f"static int {name}(int seed)\n{{\n    int acc = seed;\n"]
+        for level in range(depth):
+            pad = '    ' * (level + 1)
+            kind = level % 3
+            if kind == 0:
+                lines.append(f"{pad}if (acc >= {level}) {{\n")
+            elif kind == 1:
+                lines.append(f"{pad}for (int i{level} = 0; i{level} < 2; i{level}++) {{\n")
+            else:
+                lines.append(f"{pad}{{\n")
+            lines.append(f"{pad}    int v{level} = acc + {level};\n")
+            lines.append(f"{pad}    acc = (acc ^ v{level}) & 0x7fff;\n")
+        for level in reversed(range(depth)):
+            lines.append('    ' * (level + 1) + '}\n')
+        lines.append("    return acc;\n}\n\n")
+        self.declared.append((name, 1))
+        return ''.join(lines)
+
+    def gen_shadowing(self):
+        name = self.next_name('shadow')
+        names = ['value', 'count', 'temp', 'index', 'buffer', 'length', 'offset', 'size']
+        lines = [f"static int {name}(int value)\n{{\n    int result = value;\n"]
+        depth = self.rng.randint(3, 9)
+        for level in range(1, depth + 1):
+            pad = '    ' * level
+            lines.append(f"{pad}{{\n")
+            for var in self.rng.sample(names, 4):
+                lines.append(f"{pad}    int {var} = result + {level};\n")
+                lines.append(f"{pad}    result = (result + {var}) & 0xfff;\n")
+        for level in reversed(range(1, depth + 1)):
+            lines.append('    ' * level + '}\n')
+        lines.append("    return result;\n}\n\n")
+        self.declared.append((name, 1))
+        return ''.join(lines)
+
+    def gen_arrays(self):
+        name = self.next_name('table')
+        count = self.rng.randint(500, 4000)
+        values = [str(self.rng.randint(-100000, 100000)) for _ in range(count)]
+        rows = [', '.join(values[i:i + 12]) for i in range(0, count, 12)]
+        fn = f"sum_{name}"
+        self.declared.append((fn, 1))
+        return (f"static const int {name}[{count}] = {{\n    " + ',\n    '.join(rows) + "\n};\n\n"
+                f"static int {fn}(int unused)\n{{\n    long sum = unused;\n"
+                f"    for (int i = 0; i < {count}; i++) sum += {name}[i];\n"
+                "    return (int)(sum & 0xff);\n}\n\n")
+
+    def gen_comments(self):
+        name = self.next_name('commented')
+        words = ['the', 'value', 'is', 'computed', 'here', 'because', 'of', 'legacy', 'reasons',
+                 "don't", 'touch', '"quoted"', 'x = y;', '/* nested?', '// inner']
+        def sentence(n):
+            return ' '.join(self.rng.choice(words) for _ in range(n)).replace('*/', '* /')
+        lines = [f"/*\n * {sentence(12)}\n * {sentence(10)}\n */\n",
+                 f"static int {name}(int input) // {sentence(6)}\n{{\n"]
+        for i in range(self.rng.randint(4, 12)):
+            lines.append(f"    // {sentence(8)}\n")
+            lines.append(f"    int step{i} = input * {i + 1}; /* {sentence(5)} */\n")
+            lines.append(f"    input = (input + step{i}) & 0x3ff;\n")
+        lines.append("    return input; /* done */\n}\n\n")
+        self.declared.append((name, 1))
+        return ''.join(lines)
+
+    def gen_macros(self):
+        name = self.next_name('macro')
+        upper = name.upper()
+        self.declared.append((name, 1))
+        return (f"#define {upper}_SCALE {self.rng.randint(2, 9)}\n"
+                f"#define {upper}_APPLY(a, b) ((a) * {upper}_SCALE + (b))\n"
+                f"#define {upper}_LONG(x) \\\n    do {{ \\\n        (x) += {upper}_SCALE; \\\n"
+                f"    }} while (0)\n"
+                f"#ifdef {upper}_SCALE\n"
+                f"static int {name}(int arg)\n{{\n    int out = {upper}_APPLY(arg, 1);\n"
+                f"    {upper}_LONG(out);\n    return out & 0xff;\n}}\n"
+                f"#else\n#error {upper}_SCALE missing\n#endif\n\n")
+
+    def gen_main(self):
+        calls = ''.join(f"    check += {name}({', '.join(['3'] * arity)}) & 1;\n"
+                        for name, arity in self.declared)
+        return ("int main(void)\n{\n    int check = 0;\n" + calls +
+                "    printf(\"%d\\n\", check >= 0);\n    return 0;\n}\n")
+
+
+def measure(path, repeat):
+    """Time each phase of minifying one file (best of repeat runs)"""
+    source = minify.read_source(path)
+    parser = minify.get_parser()
+    best = None
+    out_bytes = 0
+    for _ in range(repeat):
+        phases = {}
+        start = time.perf_counter()
+        tree = parser.parse(source)
+        phases['parse'] = time.perf_counter() - start
+
+        minifier = minify.CMinifier(source, parser, tree=tree)
+        t = time.perf_counter()
+        minifier.walk()
+        phases['walk'] = time.perf_counter() - t
+
+        t = time.perf_counter()
+        if minifier.enable_renaming:
+            minifier.resolve_identifiers()
+        phases['resolve'] = time.perf_counter() - t
+
+        t = time.perf_counter()
+        out_bytes = len(minifier.emit())
+        phases['emit'] = time.perf_counter() - t
+        phases['total'] = time.perf_counter() - start
+
+        if best is None or phases['total'] < best['total']:
+            best = phases
+
+    in_bytes = len(source)
+    return {
+        'file': path,
+        'input_bytes': in_bytes,
+        'output_bytes': out_bytes,
+        'seconds': {phase: round(value, 6) for phase, value in best.items()},
+        'mb_per_s': round(in_bytes / (1 << 20) / best['total'], 3) if best['total'] else None,
+        # ru_maxrss is in KiB on Linux (bytes on macOS)
+        'peak_rss_kb': resource.getrusage(resource.RUSAGE_SELF).ru_maxrss,
+    }
+
+
+def measure_in_subprocess(path, repeat):
+    """Run measure() in a fresh interpreter so peak RSS belongs to this file alone"""
+    result = subprocess.run(
+        [sys.executable, os.path.abspath(__file__), 'measure', '--repeat', str(repeat), path],
+        stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        return {'file': path, 'error': result.stderr.strip().splitlines()[-1:]}
+    return json.loads(result.stdout)
+
+
+def run_benchmarks(files, repeat):
+    """Report dict for a list of files"""
+    return {
+        'format': REPORT_FORMAT,
+        'minifier_version': minify.MINIFIER_VERSION,
+        'python': platform.python_version(),
+        'platform': platform.platform(),
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+        'repeat': repeat,
+        'results': [measure_in_subprocess(path, repeat) for path in files],
+    }
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Benchmark the C minifier')
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    generate = commands.add_parser('generate', help='write one synthetic C file')
+    generate.add_argument('--shape', choices=SHAPES, default='mixed')
+    generate.add_argument('--size', default='1M', help='approximate size, e.g. 100K, 2M')
+    generate.add_argument('--seed', type=int, default=0)
+    generate.add_argument('-o', '--output', required=True)
+
+    run = commands.add_parser('run', help='generate a corpus (or take files) and benchmark it')
+    run.add_argument('--shapes', default=','.join(SHAPES), help='comma-separated shapes')
+    run.add_argument('--sizes', default=DEFAULT_SIZES, help='comma-separated sizes')
+    run.add_argument('--seed', type=int, default=0)
+    run.add_argument('--files', nargs='+', default=None, help='benchmark these files instead')
+    run.add_argument('--corpus-dir', default=None, help='keep the generated corpus here')
+    run.add_argument('--repeat', type=int, default=3, help='runs per file; the best is kept')
+    run.add_argument('--json', default=None, help='write the report here instead of stdout')
+
+    one = commands.add_parser('measure', help=argparse.SUPPRESS)
+    one.add_argument('--repeat', type=int, default=1)
+    one.add_argument('file')
+
+    args = parser.parse_args(argv)
+
+    if args.command == 'generate':
+        source = CorpusGenerator(args.shape, args.seed).generate(parse_size(args.size))
+        with open(args.output, 'w') as f:
+            f.write(source)
+        return 0
+
+    if args.command == 'measure':
+        print(json.dumps(measure(args.file, args.repeat)))
+        return 0
+
+    with tempfile.TemporaryDirectory(prefix='cminify-bench-') as tmp:
+        files = args.files
+        if files is None:
+            corpus = args.corpus_dir or tmp
+            os.makedirs(corpus, exist_ok=True)
+            files = []
+            for shape in args.shapes.split(','):
+                for size in args.sizes.split(','):
+                    path = os.path.join(corpus, f"{shape}_{size}.c")
+                    source = CorpusGenerator(shape, args.seed).generate(parse_size(size))
+                    with open(path, 'w') as f:
+                        f.write(source)
+                    files.append(path)
+        report = run_benchmarks(files, args.repeat)
+
+    for result in report['results']:
+        if 'error' in result:
+            print(f"FAILED {result['file']}: {result['error']}", file=sys.stderr)
+        else:
+            print(f"{os.path.basename(result['file']):>24} {result['input_bytes']:>10} B "
+                  f"{result['seconds']['total']:>8.3f} s {result['mb_per_s']:>7} MB/s "
+                  f"{result['peak_rss_kb']:>8} KiB", file=sys.stderr)
+
+    text = json.dumps(report, indent=2)
+    if args.json:
+        with open(args.json, 'w') as f:
+            f.write(text + '\n')
+    else:
+        print(text)
+    return 1 if any('error' in result for result in report['results']) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""
+Content-addressed on-disk cache for minifier results
+
+Entries are keyed by a hash of the source bytes, the minifier options and
+a version stamp, so a change to any of them is a miss, never a stale hit.
+Several processes may share one cache directory:
+- writes go to a temporary file that is atomically renamed into place
+- readers treat a vanished entry (evicted concurrently) as a miss
+- eviction removes least-recently-used entries until under the size limit
+
+Usage: python3 cache.py [--cache-dir DIR] {stats,clear,evict}
+"""
+
+import argparse
+import hashlib
+import os
+import re
+import sys
+import tempfile
+
+import minify
+
+DEFAULT_CACHE_DIR = os.path.join(os.path.expanduser('~'), '.cache', 'cminify')
+DEFAULT_MAX_BYTES = 256 * 1024 * 1024
+
+# Suffix of finished entries; temporary files use a different one
+ENTRY_SUFFIX = '.min'
+# Modules the output is computed by: the minifier and its optional passes
+PASS_MODULES = ('minify', 'deadcode', 'literals')
+# An import statement, top-level or inside a function, and the module it names
+IMPORT = re.compile(rb'^[ \t]*(?:import|from)[ \t]+(\w+)', re.M)
+
+
+def output_modules(directory):
+    """Sorted paths of PASS_MODULES and every local module they import, transitively
+
+    Imports inside functions count too, since the passes import lazily.
+    """
+    found = {}
+    pending = list(PASS_MODULES)
+    while pending:
+        name = pending.pop()
+        path = os.path.join(directory, name + '.py')
+        if name in found or not os.path.isfile(path):
+            continue
+        with open(path, 'rb') as f:
+            found[name] = path
+            pending.extend(m.decode('ascii') for m in IMPORT.findall(f.read()))
+    return sorted(found.values())
+
+
+def version_stamp():
+    """Minifier version plus a digest of its code, so code edits invalidate entries
+
+    Every local module the passes import counts as well.
+    """
+    h = hashlib.sha256()
+    for path in output_modules(os.path.dirname(os.path.abspath(minify.__file__))):
+        with open(path, 'rb') as f:
+            h.update(f.read())
+    return f"{minify.MINIFIER_VERSION}:{h.hexdigest()[:16]}"
+
+
+class ResultCache:
+    """Content-addressed store of minified outputs in a shared directory"""
+    def __init__(self, directory=DEFAULT_CACHE_DIR, max_bytes=DEFAULT_MAX_BYTES):
+        self.directory = directory
+        self.max_bytes = max_bytes
+        self.stamp = version_stamp().encode('utf-8')
+        self.hits = 0
+        self.misses = 0
+        self.bytes_served = 0  # output bytes answered from the cache
+        self.bytes_written = 0  # bytes added since the last eviction
+        os.makedirs(directory, exist_ok=True)
+
+    def key(self, source_bytes, enable_renaming, remove_dead_code=False, compact_literals=False,
+            name_order='uses', header=False):
+        """Hash of version stamp, options and source"""
+        h = hashlib.sha256(self.stamp)
+        h.update(b'\0rename=1\0' if enable_renaming else b'\0rename=0\0')
+        h.update(f"deadcode={int(remove_dead_code)}\0literals={int(compact_literals)}\0"
+                 f"order={name_order}\0header={int(header)}\0".encode('utf-8'))
+        h.update(source_bytes)
+        return h.hexdigest()
+
+    def path(self, key):
+        return os.path.join(self.directory, key[:2], key + ENTRY_SUFFIX)
+
+    def get(self, key):
+        """Cached output bytes, or None on a miss"""
+        path = self.path(key)
+        try:
+            with open(path, 'rb') as f:
+                data = f.read()
+            # Refresh the timestamp eviction uses for recency
+            os.utime(path)
+        except FileNotFoundError:
+            self.misses += 1
+            return None
+        self.hits += 1
+        self.bytes_served += len(data)
+        return data
+
+    def put(self, key, data):
+        """Store output bytes atomically; concurrent writers of one key are harmless"""
+        path = self.path(key)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, tmp_path = tempfile.mkstemp(dir=os.path.dirname(path), suffix='.tmp')
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write(data)
+            os.replace(tmp_path, path)
+        except BaseException:
+            try:
+                os.unlink(tmp_path)
+            except FileNotFoundError:
+                pass
+            raise
+        self.bytes_written += len(data)
+        # Check the size limit once every tenth of the budget has been written
+        if self.bytes_written > self.max_bytes // 10:
+            self.evict()
+
+    def minify(self, source, enable_renaming=None, parser=None, remove_dead_code=False,
+               compact_literals=False, name_order='uses', header=False):
+        """CMinifier(source, ...).minify() through the cache; source is bytes-like, result bytes"""
+        if enable_renaming is None:
+            enable_renaming = minify.ENABLE_RENAMING
+        if isinstance(source, str):
+            source = source.encode('utf-8')
+        key = self.key(source, enable_renaming, remove_dead_code, compact_literals, name_order,
+                       header)
+        data = self.get(key)
+        if data is not None:
+            return data
+        result = minify.CMinifier(source, parser, enable_renaming=enable_renaming,
+                                  remove_dead_code=remove_dead_code,
+                                  compact_literals=compact_literals,
+                                  name_order=name_order, header=header).minify()
+        self.put(key, result)
+        return result
+
+    def entries(self):
+        """(mtime, size, path) of every finished entry"""
+        found = []
+        for root, _, files in os.walk(self.directory):
+            for name in files:
+                if not name.endswith(ENTRY_SUFFIX):
+                    continue
+                path = os.path.join(root, name)
+                try:
+                    st = os.stat(path)
+                except FileNotFoundError:
+                    continue
+                found.append((st.st_mtime, st.st_size, path))
+        return found
+
+    def evict(self):
+        """Remove least-recently-used entries until the cache fits max_bytes"""
+        self.bytes_written = 0
+        entries = self.entries()
+        total = sum(size for _, size, _ in entries)
+        removed = 0
+        for _, size, path in sorted(entries):
+            if total <= self.max_bytes:
+                break
+            try:
+                os.unlink(path)
+            except FileNotFoundError:
+                pass  # already evicted by another process
+            total -= size
+            removed += 1
+        return removed
+
+    def clear(self):
+        for _, _, path in self.entries():
+            try:
+                os.unlink(path)
+            except FileNotFoundError:
+                pass
+
+    def stats(self):
+        """Hit/miss counters of this instance"""
+        lookups = self.hits + self.misses
+        return {
+            'hits': self.hits,
+            'misses': self.misses,
+            'hit_rate': round(self.hits / lookups, 4) if lookups else 0.0,
+            'bytes_served': self.bytes_served,
+        }
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Manage the minifier result cache')
+    parser.add_argument('--cache-dir', default=DEFAULT_CACHE_DIR)
+    parser.add_argument('--max-bytes', type=int, default=DEFAULT_MAX_BYTES)
+    parser.add_argument('command', choices=['stats', 'clear', 'evict'])
+    args = parser.parse_args(argv)
+
+    cache = ResultCache(args.cache_dir, args.max_bytes)
+    if args.command == 'clear':
+        cache.clear()
+    elif args.command == 'evict':
+        print(f"Evicted {cache.evict()} entries")
+    else:
+        entries = cache.entries()
+        print(f"{len(entries)} entries, {sum(size for _, size, _ in entries)} bytes "
+              f"in {args.cache_dir} (limit {args.max_bytes})")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
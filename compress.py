@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Compression-tuned minification
+
+Minified sources usually ship compressed, so the size that counts is the
+compressed one. Fewest raw bytes and best compression pull apart in how
+locals are named:
+- 'uses': the most referenced local of each function gets the shortest
+  name, which minimizes raw bytes
+- 'declaration': locals are named in declaration order, so the first
+  parameter is always 'a' and functions of the same shape become the same
+  byte sequences, which the compressor matches as long repeats
+Each strategy is minified from one parse and compressed with the target
+codec; the smallest compressed output wins. Both sizes are reported side
+by side, and the winner can be written precompressed.
+
+Usage: python3 compress.py [--codec gzip|zstd] [-o OUTPUT] [--gz] [--zst]
+                          [--remove-dead-code] [--compact-literals] <file.c>
+"""
+
+import argparse
+import gzip
+import sys
+
+import minify
+
+GZIP_LEVEL = 9
+ZSTD_LEVEL = 19
+
+
+def zstd_compressor():
+    """The zstandard module's compressor, or None where it is not installed"""
+    try:
+        import zstandard
+    except ImportError:
+        return None
+    return zstandard.ZstdCompressor(level=ZSTD_LEVEL)
+
+
+def compress(data, codec):
+    """data compressed with codec ('gzip' or 'zstd'), reproducibly"""
+    if codec == 'gzip':
+        return gzip.compress(data, GZIP_LEVEL, mtime=0)
+    if codec == 'zstd':
+        compressor = zstd_compressor()
+        if compressor is None:
+            raise RuntimeError("zstd needs the 'zstandard' module (pip install zstandard)")
+        return compressor.compress(data)
+    raise ValueError(f"unknown codec: {codec}")
+
+
+def minify_for_compression(source, codec='gzip', enable_renaming=None, remove_dead_code=False,
+                           compact_literals=False):
+    """(output, report): the minified source that compresses smallest
+
+    remove_dead_code and compact_literals apply to every strategy. report
+    holds the input's and every strategy's raw and compressed sizes, and
+    the chosen strategy.
+    """
+    if isinstance(source, str):
+        source = source.encode('utf-8')
+    tree = minify.get_parser().parse(source)
+    report = {
+        'codec': codec,
+        'input': {'raw': len(source), 'compressed': len(compress(source, codec))},
+        'strategies': {},
+    }
+    best = None
+    for order in minify.NAME_ORDERS:
+        minifier = minify.CMinifier(source, tree=tree, enable_renaming=enable_renaming,
+                                    remove_dead_code=remove_dead_code,
+                                    compact_literals=compact_literals, name_order=order)
+        output = minifier.minify()
+        size = len(compress(output, codec))
+        report['strategies'][order] = {'raw': len(output), 'compressed': size}
+        if best is None or size < best[0]:
+            best = (size, order, output)
+        if not minifier.enable_renaming:
+            break  # without renaming every strategy gives the same output
+    report['chosen'] = best[1]
+    return best[2], report
+
+
+def format_report(report):
+    """Raw and compressed sizes side by side, the chosen strategy starred"""
+    codec = report['codec']
+    rows = [('input', report['input'])] + list(report['strategies'].items())
+    width = max(len(name) for name, _ in rows)
+    lines = [f"{'':{width}}  {'raw':>10}  {codec:>10}"]
+    for name, sizes in rows:
+        mark = ' *' if name == report['chosen'] else ''
+        lines.append(f"{name:{width}}  {sizes['raw']:>10}  {sizes['compressed']:>10}{mark}")
+    return '\n'.join(lines)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description='Minify one C file for the smallest compressed size')
+    parser.add_argument('file')
+    parser.add_argument('--codec', choices=('gzip', 'zstd'), default='gzip',
+                        help='compressor to optimize for (default: gzip)')
+    parser.add_argument('-o', '--output', default=None, help='write here instead of stdout')
+    parser.add_argument('--gz', action='store_true', help='also write OUTPUT.gz')
+    parser.add_argument('--zst', action='store_true', help='also write OUTPUT.zst')
+    parser.add_argument('--no-rename', action='store_true', help='disable variable renaming')
+    parser.add_argument('--remove-dead-code', action='store_true',
+                        help='drop unreferenced statics and unused locals')
+    parser.add_argument('--compact-literals', action='store_true',
+                        help='fold constants and shorten literals')
+    args = parser.parse_args(argv)
+    if (args.gz or args.zst) and not args.output:
+        parser.error('--gz and --zst need -o')
+
+    try:
+        output, report = minify_for_compression(minify.read_source(args.file), args.codec,
+                                                enable_renaming=False if args.no_rename else None,
+                                                remove_dead_code=args.remove_dead_code,
+                                                compact_literals=args.compact_literals)
+        output += b'\n'
+        if args.output:
+            with open(args.output, 'wb') as f:
+                f.write(output)
+            for wanted, codec, suffix in ((args.gz, 'gzip', '.gz'), (args.zst, 'zstd', '.zst')):
+                if wanted:
+                    with open(args.output + suffix, 'wb') as f:
+                        f.write(compress(output, codec))
+        else:
+            sys.stdout.buffer.write(output)
+    except (OSError, RuntimeError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+    print(format_report(report), file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
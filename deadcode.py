@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+Dead-code elimination for static definitions and unused locals
+
+Uses only what the minifier's walk already records:
+1. Reference graph: every top-level declaration is a node; its edges are
+   the file-scope names its identifier events refer to (uses that no
+   local binding captures, block-scope extern declarations)
+2. Roots: everything that is not a static definition or prototype, since
+   other translation units, the preprocessor or the debugger may see it,
+   and in a header every top-level definition, as each includer may use it;
+   words in preprocessor directives count as references, as macro bodies
+   are opaque to the walk. A static declaration whose type defines a
+   struct, union or enum body is a root too, as the tag and constants are
+   not tracked
+3. Static functions and variables not reachable from the roots are
+   dropped together with their prototypes; reachability is a fixed point,
+   so a static only used by other dead statics goes too
+4. Local declaration statements whose variables are never used and whose
+   initializers are literals are dropped as well, unless they define a
+   struct, union or enum body
+
+Usage: python3 deadcode.py <file.c|file.h>    (report only; see minify.py --remove-dead-code)
+"""
+
+import bisect
+import re
+import sys
+
+import minify
+from project import DIRECTIVE, WORD, declarator_name, storage_classes
+
+# Attributes that keep an otherwise unreferenced definition alive
+KEEP_ATTRIBUTES = re.compile(rb'__attribute__\s*\(\(.*\b(used|constructor|destructor)\b', re.S)
+# Initializer nodes an unused local may be dropped with: no calls, no
+# reads of other objects, so nothing observable goes away
+PURE_TYPES = {'number_literal', 'char_literal', 'string_literal', 'concatenated_string',
+              'string_content', 'escape_sequence', 'true', 'false', 'null',
+              'initializer_list', 'initializer_pair', 'field_designator',
+              'subscript_designator', 'field_identifier', 'unary_expression',
+              'binary_expression', 'parenthesized_expression'}
+# Declarators an unused local may be dropped with (no VLA sizes to evaluate)
+PLAIN_DECLARATORS = {'identifier', 'pointer_declarator', 'array_declarator', 'init_declarator'}
+# Type specifiers that may define a tag, or enumeration constants, in passing
+TAGGED_TYPES = {'struct_specifier', 'union_specifier', 'enum_specifier'}
+
+
+def is_pure(node):
+    """True if evaluating node has no effect and reads no object"""
+    stack = [node]
+    while stack:
+        node = stack.pop()
+        if node.is_named and node.type not in PURE_TYPES:
+            return False
+        stack.extend(node.children)
+    return True
+
+
+def defines_type(node):
+    """True if a declaration's type is a struct, union or enum with a body
+
+    Dropping it would lose the tag and the enumeration constants with it.
+    """
+    specifier = node.child_by_field_name('type')
+    return (specifier is not None and specifier.type in TAGGED_TYPES
+            and specifier.child_by_field_name('body') is not None)
+
+
+def item_names(node, source_bytes):
+    """Static names a top-level node defines or declares, else None (a root)"""
+    if node.type not in ('function_definition', 'declaration'):
+        return None
+    if b'static' not in storage_classes(node, source_bytes):
+        return None
+    if defines_type(node):
+        return None
+    if KEEP_ATTRIBUTES.search(source_bytes[node.start_byte:node.end_byte]):
+        return None
+    if node.type == 'function_definition':
+        declarators = [node.child_by_field_name('declarator')]
+    else:
+        declarators = node.children_by_field_name('declarator')
+    names = set()
+    for declarator in declarators:
+        name, _ = declarator_name(declarator, source_bytes)
+        if name is None:
+            return None
+        names.add(name)
+    return names or None
+
+
+class DeadCodeFinder:
+    """Decides which subtrees of one walked CMinifier can be left out"""
+    def __init__(self, minifier):
+        self.minifier = minifier
+        self.source_bytes = minifier.source_bytes
+        self.children = minifier.tree.root_node.children
+        # A header's statics are its interface to the files including it
+        self.header = minifier.header
+        self.starts = [child.start_byte for child in self.children]
+        # Words of every directive: macro bodies may name anything
+        self.macro_words = set()
+        for match in DIRECTIVE.finditer(self.source_bytes):
+            self.macro_words.update(WORD.findall(match.group()))
+
+    def item_of(self, offset):
+        """Index of the top-level child containing a byte offset"""
+        return bisect.bisect_right(self.starts, offset) - 1
+
+    def resolve(self):
+        """File-scope references per top-level child, and uses of every local
+
+        Mirrors resolve_identifiers(): file-scope parameter names and
+        declarations are not references. Returns (references, locals) where
+        references[i] is a set of names and locals maps each local's
+        declaration offset to [end, uses].
+        """
+        references = [set() for _ in self.children]
+        locals_ = {}  # declaration start -> [end, uses]
+        visible = {}  # name -> stack of declaration starts (None: extern)
+        marks = []  # names declared in each open scope
+        depth_of = {}  # declaration start -> number of scopes open there
+        redeclared = {}  # declaration start -> start of the first one in its scope
+        for event in self.minifier.events:
+            kind = event[0]
+            if kind == minify.EV_ENTER:
+                marks.append([])
+            elif kind == minify.EV_EXIT:
+                for name in marks.pop():
+                    visible[name].pop()
+            elif marks:
+                _, start, end, name = event
+                if kind == minify.EV_DECL_LOCAL:
+                    locals_[start] = [end, 0]
+                    chain = visible.get(name)
+                    if chain and chain[-1] is not None and depth_of[chain[-1]] == len(marks):
+                        # Declared again in the same scope, as the arms of
+                        # an #ifdef/#else do: one object, one use count
+                        redeclared[start] = chain[-1]
+                        continue
+                    depth_of[start] = len(marks)
+                    visible.setdefault(name, []).append(start)
+                    marks[-1].append(name)
+                elif kind == minify.EV_USE:
+                    chain = visible.get(name)
+                    if chain and chain[-1] is not None:
+                        locals_[chain[-1]][1] += 1
+                    else:
+                        references[self.item_of(start)].add(name)
+                elif kind == minify.EV_DECL_KEEP:
+                    # extern/prototype at block scope: names the file-scope object
+                    references[self.item_of(start)].add(name)
+                    visible.setdefault(name, []).append(None)
+                    marks[-1].append(name)
+            elif kind == minify.EV_USE:
+                # File-scope initializer referring to an earlier static
+                references[self.item_of(event[1])].add(event[3])
+        for start, first in redeclared.items():
+            locals_[start][1] = locals_[first][1]
+        return references, locals_
+
+    def find(self):
+        """(skip set of (start, end), report dict)"""
+        source_bytes = self.source_bytes
+        references, locals_ = self.resolve()
+
+        # Reachability from the roots over static names
+        defined_by = {}  # static name -> indexes of the items declaring it
+        live = [True] * len(self.children)
+        pending = []
+        for i, child in enumerate(self.children):
+            names = None if self.header else item_names(child, source_bytes)
+            if names is None:
+                pending.append(i)
+                continue
+            live[i] = False
+            for name in names:
+                defined_by.setdefault(name, []).append(i)
+        reached = set(self.macro_words)
+        for name in reached:
+            for j in defined_by.get(name, ()):
+                if not live[j]:
+                    live[j] = True
+                    pending.append(j)
+        while pending:
+            i = pending.pop()
+            for name in references[i]:
+                if name in reached:
+                    continue
+                reached.add(name)
+                for j in defined_by.get(name, ()):
+                    if not live[j]:
+                        live[j] = True
+                        pending.append(j)
+
+        skip = set()
+        report = {'functions': [], 'variables': [], 'prototypes': 0, 'locals': []}
+        for i, child in enumerate(self.children):
+            if live[i]:
+                continue
+            skip.add((child.start_byte, child.end_byte))
+            names = sorted(name.decode('utf-8', 'replace')
+                           for name in item_names(child, source_bytes))
+            if child.type == 'function_definition':
+                report['functions'].extend(names)
+            elif any(declarator_name(d, source_bytes)[1]
+                     for d in child.children_by_field_name('declarator')):
+                report['prototypes'] += 1
+            else:
+                report['variables'].extend(names)
+
+        # Unused locals, in live code only
+        root = self.minifier.tree.root_node
+        declarations = {}  # (start, end) -> declaration node, all its locals unused
+        rejected = set()
+        for start, (end, uses) in locals_.items():
+            if not live[self.item_of(start)]:
+                continue
+            node = root.descendant_for_byte_range(start, end)
+            while node is not None and node.type != 'declaration':
+                if node.type not in PLAIN_DECLARATORS:
+                    node = None
+                    break
+                node = node.parent
+            if node is None or node.parent is None or node.parent.type != 'compound_statement':
+                continue
+            key = (node.start_byte, node.end_byte)
+            name = source_bytes[start:end]
+            if uses or name in self.macro_words or not self.removable(node):
+                rejected.add(key)
+            else:
+                declarations[key] = node
+        for key, node in declarations.items():
+            if key in rejected:
+                continue
+            skip.add(key)
+            for declarator in node.children_by_field_name('declarator'):
+                name, _ = declarator_name(declarator, source_bytes)
+                report['locals'].append(name.decode('utf-8', 'replace'))
+        return skip, report
+
+    def removable(self, node):
+        """True if dropping a local declaration statement loses no effect"""
+        source_bytes = self.source_bytes
+        if defines_type(node):
+            return False
+        for child in node.children:
+            if child.type in ('type_qualifier', 'attribute_specifier', 'attribute_declaration'):
+                if child.type != 'type_qualifier' or \
+                        source_bytes[child.start_byte:child.end_byte] == b'volatile':
+                    return False
+        for declarator in node.children_by_field_name('declarator'):
+            value = declarator.child_by_field_name('value')
+            if value is not None and not is_pure(value):
+                return False
+            while declarator is not None and declarator.type != 'identifier':
+                if declarator.type not in PLAIN_DECLARATORS:
+                    return False
+                if declarator.type == 'array_declarator':
+                    size = declarator.child_by_field_name('size')
+                    if size is not None and not is_pure(size):
+                        return False
+                declarator = declarator.child_by_field_name('declarator')
+        return True
+
+
+def live_events(events, skip):
+    """events without the identifiers inside skipped ranges
+
+    Scope events stay: a dead function leaves an empty region behind.
+    """
+    ranges = sorted(skip)
+    starts = [start for start, _ in ranges]
+    live = []
+    for event in events:
+        if len(event) > 1:
+            i = bisect.bisect_right(starts, event[1]) - 1
+            if i >= 0 and event[1] < ranges[i][1]:
+                continue
+        live.append(event)
+    return live
+
+
+def find_dead_code(minifier):
+    """(skip set, report) for a CMinifier whose walk() has run"""
+    return DeadCodeFinder(minifier).find()
+
+
+def format_report(report):
+    """One line per kind of dropped definition"""
+    lines = []
+    if report['functions']:
+        lines.append(f"static functions: {', '.join(report['functions'])}")
+    if report['variables']:
+        lines.append(f"static variables: {', '.join(report['variables'])}")
+    if report['prototypes']:
+        lines.append(f"prototypes: {report['prototypes']}")
+    if report['locals']:
+        lines.append(f"unused locals: {', '.join(report['locals'])}")
+    return '\n'.join(lines) or 'nothing to remove'
+
+
+def main(argv=None):
+    argv = sys.argv[1:] if argv is None else argv
+    if len(argv) != 1:
+        print("Usage: python3 deadcode.py <file.c>", file=sys.stderr)
+        return 1
+    minifier = minify.CMinifier(minify.read_source(argv[0]), remove_dead_code=True,
+                                header=argv[0].endswith(minify.HEADER_EXTENSIONS))
+    minifier.walk()
+    _, report = find_dead_code(minifier)
+    print(format_report(report))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
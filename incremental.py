@@ -0,0 +1,342 @@
+#!/usr/bin/env python3
+"""
+Incremental re-minification for watch mode and editor-on-save
+
+Keeps the previous tree and per-declaration results between updates:
+1. Applies text edits with Tree.edit and reparses against the old tree
+2. Re-walks only the top-level declarations inside the changed ranges
+3. Re-resolves and re-emits a declaration only when its own text, the
+   reserved names or the static globals declared before it changed;
+   every other declaration reuses its previous tokens
+
+The result is always identical to CMinifier(source).minify().
+
+Usage: python3 incremental.py [--interval SECONDS] [-o OUTPUT] <file.c>
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import minify
+
+
+class TextEdit:
+    """Replace source bytes [start_byte, old_end_byte) with new_text
+
+    Offsets refer to the source as left by the previous edit of the same
+    update, the way editors report a sequence of changes.
+    """
+    __slots__ = ('start_byte', 'old_end_byte', 'new_text')
+
+    def __init__(self, start_byte, old_end_byte, new_text):
+        self.start_byte = start_byte
+        self.old_end_byte = old_end_byte
+        self.new_text = new_text.encode('utf-8') if isinstance(new_text, str) else new_text
+
+
+class Segment:
+    """One top-level declaration plus the whitespace up to the next one
+
+    Walk results are stored relative to the segment start so they stay
+    valid when edits elsewhere move the segment.
+    """
+    __slots__ = ('text', 'node', 'start', 'events', 'names', 'statics', 'key', 'output',
+                 'head', 'head_directive', 'tail', 'tail_number', 'newline_pending')
+
+    def __init__(self, text):
+        self.text = text
+        self.node = None  # its node in the current tree
+        self.start = 0  # its offset in the current source
+        self.events = []
+        self.names = frozenset()  # function and public global names it declares
+        self.statics = ()  # static globals it declares, in order
+        self.key = None  # (reserved version, statics before it) of the cached output
+        self.output = b''
+        # Emitter state at either end of the output, for joining segments
+        self.head = b''
+        self.head_directive = False
+        self.tail = b''
+        self.tail_number = False
+        self.newline_pending = False
+
+
+def point_at(source_bytes, offset):
+    """(row, column) of a byte offset, as Tree.edit expects"""
+    row = source_bytes.count(b'\n', 0, offset)
+    return row, offset - (source_bytes.rfind(b'\n', 0, offset) + 1)
+
+
+def shift_ranges(ranges, start, old_end, new_end):
+    """Move dirty byte ranges past an edit of [start, old_end) -> [start, new_end)"""
+    delta = new_end - old_end
+    shifted = []
+    for a, b in ranges:
+        if a >= old_end:
+            a += delta
+        elif a > start:
+            a = start
+        if b >= old_end:
+            b += delta
+        elif b > start:
+            b = new_end
+        shifted.append((a, b))
+    return shifted
+
+
+class IncrementalMinifier:
+    """Minifies one file and re-minifies it cheaply after text edits
+
+    Not thread-safe; give each thread (or editor buffer) its own instance.
+    """
+    def __init__(self, source_code, parser=None, enable_renaming=None):
+        """source_code is bytes (str is encoded as UTF-8); outputs are bytes"""
+        self.parser = parser or minify.get_parser()
+        if isinstance(source_code, str):
+            source_code = source_code.encode('utf-8')
+        # A private copy: edits splice it, so a read-only mmap won't do
+        self.source_bytes = bytes(source_code)
+        self.tree = self.parser.parse(self.source_bytes)
+        self.minifier = minify.CMinifier(self.source_bytes, self.parser,
+                                         enable_renaming=enable_renaming, tree=self.tree)
+        self.segments = []
+        self.reserved = None
+        self.reserved_version = 0
+        # Segments walked / re-emitted by the last update, for diagnostics
+        self.walked = 0
+        self.emitted = 0
+        self.output = self.rebuild(None)
+
+    def minify(self):
+        """Minified output of the current source"""
+        return self.output
+
+    def update(self, edits):
+        """Apply TextEdits, reparse incrementally and return the new output"""
+        source_bytes = self.source_bytes
+        # Check every edit first: a bad one after Tree.edit would leave the
+        # old tree out of step with the source this instance still holds
+        size = len(source_bytes)
+        for edit in edits:
+            start, old_end = edit.start_byte, edit.old_end_byte
+            if not 0 <= start <= old_end <= size:
+                raise ValueError(f"Edit [{start}, {old_end}) outside the source "
+                                 f"({size} bytes)")
+            size += len(edit.new_text) - (old_end - start)
+
+        old_tree = self.tree
+        dirty = []
+        for edit in edits:
+            start, old_end = edit.start_byte, edit.old_end_byte
+            new_end = start + len(edit.new_text)
+            start_point = point_at(source_bytes, start)
+            old_end_point = point_at(source_bytes, old_end)
+            source_bytes = source_bytes[:start] + edit.new_text + source_bytes[old_end:]
+            old_tree.edit(
+                start_byte=start, old_end_byte=old_end, new_end_byte=new_end,
+                start_point=start_point, old_end_point=old_end_point,
+                new_end_point=point_at(source_bytes, new_end),
+            )
+            dirty = shift_ranges(dirty, start, old_end, new_end)
+            dirty.append((start, new_end))
+
+        self.tree = self.parser.parse(source_bytes, old_tree)
+        # Edited text plus anything the reparse restructured around it
+        dirty.extend((r.start_byte, r.end_byte) for r in old_tree.changed_ranges(self.tree))
+        self.source_bytes = source_bytes
+        self.output = self.rebuild(dirty)
+        return self.output
+
+    def set_source(self, source_code):
+        """Replace the whole source, expressed as one edit of the changed middle"""
+        new = source_code.encode('utf-8') if isinstance(source_code, str) else bytes(source_code)
+        old = self.source_bytes
+        limit = min(len(old), len(new))
+        prefix = common_prefix(old, new, limit)
+        suffix = common_prefix(old[::-1], new[::-1], limit - prefix)
+        if prefix == len(old) == len(new):
+            return self.output
+        return self.update([TextEdit(prefix, len(old) - suffix, new[prefix:len(new) - suffix])])
+
+    def split_segments(self, dirty):
+        """Top-level segments of the current tree, reusing clean walk results
+
+        dirty is None for a cold build, else the changed byte ranges.
+        """
+        source_bytes = self.source_bytes
+        children = self.tree.root_node.children
+        bounds = [0] + [child.start_byte for child in children[1:]] + [len(source_bytes)]
+
+        # Old segments by text; identical text outside the dirty ranges
+        # parses identically, so its walk results can be taken over
+        previous = {}
+        for segment in reversed(self.segments):
+            previous.setdefault(segment.text, []).append(segment)
+
+        segments = []
+        for i, child in enumerate(children):
+            start, end = bounds[i], bounds[i + 1]
+            text = source_bytes[start:end]
+            candidates = previous.get(text)
+            if (dirty is not None and candidates
+                    and not any(a <= end and b >= start for a, b in dirty)):
+                segment = candidates.pop()
+            else:
+                segment = Segment(text)
+                self.walk_segment(segment, child, start)
+            segment.node = child
+            segment.start = start
+            segments.append(segment)
+        if not children and source_bytes:
+            # Whitespace-only source
+            segments.append(Segment(source_bytes))
+        return segments
+
+    def walk_segment(self, segment, node, base):
+        """Collect a segment's names and identifier events"""
+        m = self.minifier
+        m.events = []
+        m.removals = minify.EditList()
+        m.function_names = set()
+        m.global_names = set()
+        m.walk(node)
+        segment.events = [event if len(event) == 1
+                          else (event[0], event[1] - base, event[2] - base, event[3])
+                          for event in m.events]
+        segment.names = frozenset(m.function_names | m.global_names)
+        segment.statics = tuple(event[3] for event in m.events
+                                if event[0] == minify.EV_DECL_STATIC)
+        self.walked += 1
+
+    def rebuild(self, dirty):
+        """Resolve and emit what changed, then join every segment's output"""
+        m = self.minifier
+        m.source_bytes = self.source_bytes
+        m.tree = self.tree
+        self.walked = self.emitted = 0
+        self.segments = segments = self.split_segments(dirty)
+
+        reserved = minify.KEYWORDS.union(*(segment.names for segment in segments))
+        if reserved != self.reserved:
+            self.reserved = reserved
+            self.reserved_version += 1
+            m.short_names = minify.NameSequence(reserved)
+        reserved = self.reserved
+        names = m.short_names
+
+        # Static globals are the only file-scope renames, and a declaration's
+        # output depends on the ones before it: replay them in order
+        global_scope = minify.Scope()
+        statics_before = 0  # running hash of the static names declared so far
+        for segment in segments:
+            key = (self.reserved_version, statics_before)
+            if segment.key == key:
+                for name in segment.statics:
+                    global_scope.add_variable(name, names)
+            else:
+                self.emit_segment(segment, global_scope, reserved)
+                segment.key = key
+            if segment.statics:
+                statics_before = hash((statics_before, segment.statics))
+
+        return join_segments(segments)
+
+    def emit_segment(self, segment, global_scope, reserved):
+        """Rename and emit one segment against the file-scope state so far"""
+        m = self.minifier
+        m.replacements = minify.EditList()
+        if m.enable_renaming:
+            m.scopes = [global_scope]
+            m.resolve_identifiers(segment.events, reserved)
+        base = segment.start
+        emitter = minify.TokenEmitter(self.source_bytes, m.replacements.shifted(base))
+        if segment.node is not None:
+            emitter.emit(segment.node)
+        emitter.finish(base + len(segment.text))
+        segment.output = emitter.getvalue()
+        segment.head, segment.head_directive = emitter.head or (b'', False)
+        segment.tail = emitter.prev
+        segment.tail_number = emitter.prev_number
+        segment.newline_pending = emitter.newline_pending
+        self.emitted += 1
+
+
+def join_segments(segments):
+    """Concatenate segment outputs as one TokenEmitter would the whole file
+
+    Each output was emitted on its own, so only the seams need deciding:
+    a newline before a directive or after a finished directive line, else
+    a space if the tokens on either side would merge.
+    """
+    result = []
+    prev = None
+    for segment in segments:
+        if not segment.output:
+            continue
+        if prev is not None:
+            if segment.head_directive or prev.newline_pending:
+                result.append(b'\n')
+            elif minify.needs_separator(prev.tail, prev.tail_number, segment.head):
+                result.append(b' ')
+        result.append(segment.output)
+        prev = segment
+    return b''.join(result)
+
+
+def common_prefix(a, b, limit):
+    """Length of the common prefix of two byte strings, by bisection on slices"""
+    lo, hi = 0, limit
+    while lo < hi:
+        mid = (lo + hi + 1) // 2
+        if a[lo:mid] == b[lo:mid]:
+            lo = mid
+        else:
+            hi = mid - 1
+    return lo
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description='Re-minify a C file incrementally whenever it changes')
+    parser.add_argument('file')
+    parser.add_argument('-o', '--output', default=None,
+                        help='write here instead of stdout')
+    parser.add_argument('--interval', type=float, default=0.2,
+                        help='polling interval in seconds')
+    parser.add_argument('--no-rename', action='store_true', help='disable variable renaming')
+    args = parser.parse_args(argv)
+
+    def emit(output):
+        if args.output:
+            with open(args.output, 'wb') as f:
+                f.write(output + b'\n')
+        else:
+            sys.stdout.buffer.write(output + b'\n')
+            sys.stdout.buffer.flush()
+
+    with open(args.file, 'rb') as f:
+        session = IncrementalMinifier(f.read(), enable_renaming=False if args.no_rename else None)
+    emit(session.minify())
+    mtime = os.stat(args.file).st_mtime_ns
+    try:
+        while True:
+            time.sleep(args.interval)
+            current = os.stat(args.file).st_mtime_ns
+            if current == mtime:
+                continue
+            mtime = current
+            with open(args.file, 'rb') as f:
+                source = f.read()
+            start = time.perf_counter()
+            output = session.set_source(source)
+            print(f"Re-minified {args.file} in {(time.perf_counter() - start) * 1000:.1f} ms "
+                  f"({session.walked} walked, {session.emitted} emitted)", file=sys.stderr)
+            emit(output)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
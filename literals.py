@@ -0,0 +1,579 @@
+#!/usr/bin/env python3
+"""
+Constant folding and literal compaction
+
+An opt-in pass over the AST that rewrites literals to their shortest
+equivalent spelling, for the TokenEmitter to substitute as whole tokens:
+1. Numbers: integers take the shorter of decimal and hex when that cannot
+   change their type (0x00000010 -> 16); decimal floats keep their exact
+   decimal value with the fewest digits (1.000f -> 1.f, 0.50 -> .5)
+2. Strings and chars: escapes are rewritten to the shortest sequence for
+   the same bytes ('\\x41' -> 'A', "\\x00" -> "\\0"), and adjacent plain
+   string literals are merged into one
+3. Large literal-only initializer lists are rewritten in bulk, without a
+   visit per element: every literal as above, and an explicitly sized char
+   array as a string when that is shorter ({0x41, 0x42} -> "AB")
+4. Integer constant expressions made only of int literals are folded when
+   every step is defined and stays within int; sizeof(char) counts as 1
+   only in array sizes, where its size_t type cannot matter
+Arguments of calls that may be macros are left alone, since the macro
+might turn them into strings or paste them into other tokens: calls of
+function-like macros defined in the file, of names without lowercase
+letters, and of any name the unit never declares and the C library does
+not define (a lowercase macro from a header, such as str(x)).
+
+Usage: python3 literals.py <file.c>    (prints each rewrite; see minify.py --compact-literals)
+"""
+
+import re
+import sys
+
+import minify
+
+INT_MAX = (1 << 31) - 1
+INT_MIN = -(1 << 31)
+
+INTEGER = re.compile(rb'(0[xX][0-9a-fA-F]+|0[bB][01]+|0[0-7]*|[1-9][0-9]*)([uUlL]*)')
+DECIMAL_FLOAT = re.compile(rb'([0-9]*)(?:\.([0-9]*))?(?:[eE]([+-]?)([0-9]+))?([fFlL]?)')
+# Function-like macros defined in the file
+FUNCTION_MACRO = re.compile(rb'^[ \t]*#[ \t]*define[ \t]+([A-Za-z_][A-Za-z0-9_]*)\(', re.M)
+# Callees treated as macros wherever they come from
+MACRO_LIKE = {b'assert', b'static_assert', b'_Static_assert', b'_Pragma'}
+# C library functions called without a declaration in the unit itself; a
+# macro the library defines for one must behave like the function (C11 7.1.4)
+LIBRARY_FUNCTIONS = frozenset(name.encode() for name in """
+    printf fprintf sprintf snprintf vprintf vfprintf vsprintf vsnprintf scanf fscanf sscanf
+    puts fputs fputc putc putchar gets fgets fgetc getc getchar ungetc perror
+    fopen freopen fclose fflush fread fwrite fseek ftell rewind fgetpos fsetpos feof ferror
+    clearerr remove rename tmpfile setvbuf setbuf
+    malloc calloc realloc free aligned_alloc abort exit atexit quick_exit _Exit getenv system
+    atoi atol atoll atof strtol strtoll strtoul strtoull strtod strtof strtold
+    abs labs llabs div ldiv rand srand qsort bsearch
+    memcpy memmove memset memcmp memchr strlen strcmp strncmp strcpy strncpy strcat strncat
+    strchr strrchr strstr strspn strcspn strpbrk strtok strerror strcoll strxfrm
+    isalnum isalpha isblank iscntrl isdigit isgraph islower isprint ispunct isspace isupper
+    isxdigit tolower toupper
+    sqrt pow exp log log10 log2 sin cos tan asin acos atan atan2 sinh cosh tanh
+    fabs floor ceil fmod round trunc fmin fmax hypot cbrt ldexp frexp modf
+    time clock difftime mktime localtime gmtime strftime asctime ctime
+    signal raise setjmp longjmp
+""".split())
+
+# Escapes with a letter of their own, by value
+SIMPLE_ESCAPES = {0x07: b'\\a', 0x08: b'\\b', 0x09: b'\\t', 0x0a: b'\\n',
+                  0x0b: b'\\v', 0x0c: b'\\f', 0x0d: b'\\r'}
+ESCAPE_VALUES = {ord(c): v for c, v in zip('\'"?\\abfnrtv', b'\'"?\\\a\b\f\n\r\t\v')}
+OCTAL_DIGITS = b'01234567'
+HEX_DIGITS = b'0123456789abcdefABCDEF'
+# Third characters of the trigraphs ??= ??/ ??' ??( ??) ??! ??< ??> ??-
+TRIGRAPH_ENDS = frozenset(b"=/'()!<>-")
+
+# Events of a name declared in the unit
+DECLARATION_EVENTS = (minify.EV_DECL_STATIC, minify.EV_DECL_LOCAL, minify.EV_DECL_KEEP)
+# Expressions folded into one number
+FOLDABLE_TYPES = {'binary_expression', 'unary_expression', 'parenthesized_expression',
+                  'sizeof_expression'}
+# Statements whose parenthesized condition is part of their syntax
+CONDITION_PARENTS = {'if_statement', 'while_statement', 'do_statement', 'switch_statement'}
+# Subtrees with nothing to rewrite, or where text must stay as written
+SKIPPED_TYPES = {'ERROR', 'preproc_include', 'preproc_def', 'preproc_function_def',
+                 'preproc_call', 'comment'}
+CHAR_TYPES = {b'char', b'signed char', b'unsigned char'}
+# Literals of a compacted literal-only initializer list; split() on it
+# leaves the separators at even indexes and the literals at odd ones
+LIST_LITERAL = re.compile(rb"""((?:u8|[LuU])?"(?:[^"\\\n]|\\.)*"|[LuU]?'(?:[^'\\\n]|\\.)*'"""
+                          rb"""|\.?[0-9](?:[eEpP][+-]|[A-Za-z0-9_.])*)""")
+# Bytes per string literal a char array is written as; longer data is split
+# into adjacent literals, as MSVC rejects single literals over 16 KB
+STRING_CHUNK = 4095
+
+
+class NotConstant(Exception):
+    """An expression that cannot be folded"""
+
+
+def integer_limit(suffix):
+    """Largest value whose type is the same in decimal and hex with this suffix"""
+    suffix = suffix.lower()
+    if 'u' in suffix.decode('ascii'):
+        return None  # unsigned: decimal and hex take the same types
+    if suffix == b'll':
+        return (1 << 63) - 1
+    return INT_MAX  # int, or long where long may be 32 bits
+
+
+def integer_text(value):
+    """Shortest spelling of a non-negative integer: decimal or hex"""
+    decimal = str(value).encode('ascii')
+    hexadecimal = b'0x%x' % value
+    return hexadecimal if len(hexadecimal) < len(decimal) else decimal
+
+
+def shorten_integer(text):
+    """(value, shortest spelling) of an integer literal, or None"""
+    match = INTEGER.fullmatch(text)
+    if not match:
+        return None
+    digits, suffix = match.groups()
+    if digits[:2] in (b'0x', b'0X'):
+        value = int(digits[2:], 16)
+    elif digits[:2] in (b'0b', b'0B'):
+        value = int(digits[2:], 2)
+    elif digits[:1] == b'0':
+        value = int(digits, 8)
+    else:
+        value = int(digits)
+    limit = integer_limit(suffix)
+    if limit is not None and value > limit:
+        return value, text
+    return value, integer_text(value) + suffix
+
+
+def shorten_float(text):
+    """Shortest spelling of a decimal floating literal with the same value, or None"""
+    match = DECIMAL_FLOAT.fullmatch(text)
+    if not match or (match.group(2) is None and match.group(4) is None):
+        return None
+    whole, fraction, sign, exponent, suffix = match.groups()
+    fraction = fraction or b''
+    digits = (whole + fraction).lstrip(b'0')
+    if not digits:
+        return b'0.' + suffix
+    # value = mantissa * 10**power, mantissa without trailing zeros
+    power = -len(fraction) + (int(exponent) * (-1 if sign == b'-' else 1) if exponent else 0)
+    mantissa = digits.rstrip(b'0')
+    power += len(digits) - len(mantissa)
+    if power >= 0:
+        positional = mantissa + b'0' * power + b'.'
+    elif -power < len(mantissa):
+        positional = mantissa[:power] + b'.' + mantissa[power:]
+    else:
+        positional = b'.' + b'0' * (-power - len(mantissa)) + mantissa
+    candidates = [positional]
+    if power:
+        candidates.append(mantissa + b'e' + str(power).encode('ascii'))
+    return min(candidates, key=len) + suffix
+
+
+def shorten_number(text):
+    """Shortest spelling of a number literal, or None to leave it as is"""
+    integer = shorten_integer(text)
+    if integer is not None:
+        return integer[1]
+    return shorten_float(text)
+
+
+def decode_literal(text):
+    """Contents of a plain string or char literal: byte values, with escapes
+    that have no byte value of their own (UCNs, raw non-ASCII, \\e) as bytes
+
+    Returns None for prefixed literals and line continuations.
+    """
+    quote = text[:1]
+    if quote not in (b'"', b"'") or text[-1:] != quote or len(text) < 2:
+        return None
+    items = []
+    i, end = 1, len(text) - 1
+    while i < end:
+        c = text[i]
+        if c != 0x5c:
+            items.append(c if c < 0x80 else bytes((c,)))
+            i += 1
+            continue
+        n = text[i + 1]
+        if n in ESCAPE_VALUES:
+            items.append(ESCAPE_VALUES[n])
+            i += 2
+        elif n in OCTAL_DIGITS:
+            j = i + 1
+            while j < end and j < i + 4 and text[j] in OCTAL_DIGITS:
+                j += 1
+            value = int(text[i + 1:j], 8)
+            items.append(value if value < 0x100 else text[i:j])
+            i = j
+        elif n == 0x78:  # \x: every hex digit that follows
+            j = i + 2
+            while j < end and text[j] in HEX_DIGITS:
+                j += 1
+            value = int(text[i + 2:j] or b'0', 16)
+            items.append(value if j > i + 2 and value < 0x100 else text[i:j])
+            i = j
+        elif n in b'\r\n':
+            return None
+        elif n in b'uU':
+            j = i + (6 if n == 0x75 else 10)
+            items.append(text[i:j])
+            i = j
+        else:
+            items.append(text[i:i + 2])
+            i += 2
+    return items
+
+
+def is_hex_escape(item):
+    """True if item is a kept \\x escape, which a following hex digit would extend"""
+    return isinstance(item, bytes) and item[:2] == b'\\x'
+
+
+def encode_literal(items, quote):
+    """Shortest literal text for decoded contents"""
+    out = bytearray(quote)
+    question = False  # the last byte written is an unescaped '?'
+    for k, item in enumerate(items):
+        following = items[k + 1] if k + 1 < len(items) else None
+        if isinstance(item, bytes):
+            out += item
+        elif item == quote[0] or item == 0x5c:
+            out += b'\\' + bytes((item,))
+        elif item == 0x3f and question and following in TRIGRAPH_ENDS:
+            out += b'\\?'  # never spell out a trigraph
+            question = False
+            continue
+        elif 0x20 <= item < 0x7f and not (item in HEX_DIGITS and k and is_hex_escape(items[k - 1])):
+            out.append(item)
+        elif item in SIMPLE_ESCAPES:
+            out += SIMPLE_ESCAPES[item]
+        else:
+            # Octal takes at most three digits: pad when a digit follows
+            octal = b'%o' % item
+            if isinstance(following, int) and following in OCTAL_DIGITS:
+                octal = octal.rjust(3, b'0')
+            out += b'\\' + octal
+        question = item == 0x3f
+    out += quote
+    return bytes(out)
+
+
+def shorten_literal(text):
+    """Shortest spelling of a string or char literal, or None"""
+    items = decode_literal(text)
+    if items is None:
+        return None
+    if text[:1] == b"'" and len(items) != 1:
+        return None  # multi-character constants have implementation-defined values
+    return encode_literal(items, text[:1])
+
+
+class LiteralCompactor:
+    """Collects the literal and constant rewrites of one CMinifier's tree"""
+    def __init__(self, minifier):
+        self.source_bytes = minifier.source_bytes
+        self.tree = minifier.tree
+        self.macros = set(FUNCTION_MACRO.findall(self.source_bytes)) | MACRO_LIKE
+        # Names a call may use as a plain function: declared in the unit
+        # (functions, and variables holding function pointers) or the library's
+        self.functions = set(LIBRARY_FUNCTIONS)
+        self.functions.update(minifier.function_names, minifier.global_names)
+        self.functions.update(event[3] for event in minifier.events
+                              if event[0] in DECLARATION_EVENTS)
+        # constant() results by span, outside and inside array sizes
+        self.values = {False: {}, True: {}}
+
+    def text(self, node):
+        return bytes(self.source_bytes[node.start_byte:node.end_byte])
+
+    def is_macro_call(self, node):
+        """True if a call_expression may be a macro invocation"""
+        function = node.child_by_field_name('function')
+        if function is None or function.type != 'identifier':
+            return False
+        name = self.text(function)
+        # Spelled like a macro (no lowercase letters), or declared nowhere
+        # the unit can see: most likely a macro from a header
+        return name in self.macros or name == name.upper() or name not in self.functions
+
+    def compact(self):
+        """{(start_byte, end_byte): (text, node_type)} of every rewrite that saves bytes"""
+        folded = {}
+        cursor = self.tree.walk()
+        while True:
+            node = cursor.node
+            node_type = node.type
+            replacement = None
+            descend = True
+            if node_type in SKIPPED_TYPES:
+                descend = False
+            elif node_type == 'number_literal':
+                replacement = shorten_number(self.text(node))
+                descend = False
+            elif node_type in ('string_literal', 'char_literal'):
+                replacement = shorten_literal(self.text(node))
+                descend = False
+            elif node_type == 'concatenated_string':
+                replacement = self.merge_strings(node)
+                if replacement is not None:
+                    node_type = 'string_literal'
+                    descend = False
+            elif node_type in FOLDABLE_TYPES:
+                replacement = self.fold(node)
+                if replacement is not None:
+                    node_type = 'number_literal'
+                    descend = False
+            elif (node_type == 'initializer_list'
+                    and node.end_byte - node.start_byte >= minify.BULK_BYTES):
+                replacement = self.literal_list(node)
+                descend = replacement is None
+            elif node_type == 'argument_list' and self.is_macro_call(node.parent):
+                descend = False
+            if replacement is not None and len(replacement) < node.end_byte - node.start_byte:
+                folded[(node.start_byte, node.end_byte)] = (replacement, node_type)
+            if descend and cursor.goto_first_child():
+                continue
+            while not cursor.goto_next_sibling():
+                if not cursor.goto_parent():
+                    return folded
+
+    def literal_list(self, node):
+        """Shortest spelling of a literal-only initializer list, or None if it is not one"""
+        text = minify.compact_literal_list(self.text(node))
+        if text is None:
+            return None
+        pieces = LIST_LITERAL.split(text)
+        spellings = {}  # generated data repeats its values
+        for i in range(1, len(pieces), 2):
+            token = pieces[i]
+            spelling = spellings.get(token)
+            if spelling is None:
+                if token[0] in b'0123456789.':
+                    shorter = shorten_number(token)
+                else:
+                    shorter = shorten_literal(token)
+                if shorter is None or len(shorter) >= len(token):
+                    shorter = token
+                spelling = spellings[token] = shorter
+            pieces[i] = spelling
+        text = b''.join(pieces)
+        string = self.char_array_string(node, pieces)
+        return string if string is not None and len(string) < len(text) else text
+
+    def char_array_string(self, node, pieces):
+        """The string literal an initializer list of a char array amounts to, or None
+
+        Only for a one-dimensional array of explicit size: with [] the
+        string's terminating null would make the array one longer. Plain
+        and signed char take values up to 127, whose conversion is defined.
+        """
+        parent = node.parent
+        if parent is None or parent.type != 'init_declarator':
+            return None
+        declarator = parent.child_by_field_name('declarator')
+        if declarator is None or declarator.type != 'array_declarator':
+            return None
+        name = declarator.child_by_field_name('declarator')
+        size = declarator.child_by_field_name('size')
+        if name is None or name.type != 'identifier' or size is None or size.type != 'number_literal':
+            return None
+        length = shorten_integer(self.text(size))
+        type_node = parent.parent.child_by_field_name('type') if parent.parent is not None else None
+        if length is None or type_node is None:
+            return None
+        kind = b' '.join(self.text(type_node).split())
+        if kind not in CHAR_TYPES:
+            return None
+        if len(pieces) < 3 or pieces[0] != b'{' or pieces[-1] not in (b'}', b',}') \
+                or any(separator != b',' for separator in pieces[2:-1:2]):
+            return None  # nested braces or signs
+        limit = 0xff if kind == b'unsigned char' else 0x7f
+        values = {}
+        for token in set(pieces[1::2]):
+            if token[:1] == b"'":
+                # A char constant stores the same byte either way
+                decoded = decode_literal(token)
+                if decoded is None or len(decoded) != 1 or not isinstance(decoded[0], int):
+                    return None
+                values[token] = decoded[0]
+                continue
+            integer = shorten_integer(token)
+            if integer is None or integer[0] > limit:
+                return None
+            values[token] = integer[0]
+        items = [values[token] for token in pieces[1::2]]
+        if len(items) > length[0]:
+            return None
+        return b''.join(encode_literal(items[i:i + STRING_CHUNK], b'"')
+                        for i in range(0, len(items), STRING_CHUNK))
+
+    def merge_strings(self, node):
+        """One literal for adjacent plain string literals, or None"""
+        items = []
+        for child in node.children:
+            if child.type == 'comment':
+                continue
+            if child.type != 'string_literal':
+                return None
+            decoded = decode_literal(self.text(child))
+            if decoded is None:
+                return None
+            items.extend(decoded)
+        return encode_literal(items, b'"')
+
+    def fold(self, node):
+        """Spelling of a foldable integer constant expression, or None"""
+        if node.type == 'parenthesized_expression' and node.parent is not None \
+                and node.parent.type in CONDITION_PARENTS:
+            return None  # 'if (1+2)' must keep its parentheses; fold inside
+        sizes = node.parent is not None and node.parent.type == 'array_declarator'
+        result = self.constant(node, sizes)
+        if result is None:
+            return None
+        value, cost = result
+        if value < 0:
+            return None  # '-3' would bind differently than '(1-4)' after '[' or '.'
+        text = integer_text(value)
+        return text if len(text) < cost else None
+
+    def constant(self, node, sizes):
+        """(int value, bytes it takes minified) of a constant expression, or None
+
+        compact() tries every enclosing expression before the ones inside
+        it, so results are kept per span: each node is evaluated once, and
+        a chain like 'x + 1 + 2 + ...' fails in constant time at every
+        level. Operands are evaluated bottom-up from an explicit stack, so
+        no chain is too deep.
+        """
+        values = self.values[sizes]
+        key = (node.start_byte, node.end_byte)
+        if key not in values:
+            stack = [node]
+            while stack:
+                current = stack[-1]
+                operands = [operand for operand in self.operands(current)
+                            if (operand.start_byte, operand.end_byte) not in values]
+                if operands:
+                    stack.extend(operands)
+                    continue
+                stack.pop()
+                try:
+                    values[(current.start_byte, current.end_byte)] = self.evaluate(current, sizes)
+                except NotConstant:
+                    values[(current.start_byte, current.end_byte)] = None
+        return values[key]
+
+    def operands(self, node):
+        """Subexpressions evaluate() needs the constant() of"""
+        node_type = node.type
+        if node_type == 'parenthesized_expression':
+            operands = [child for child in node.named_children if child.type != 'comment']
+            return operands if len(operands) == 1 else []
+        if node_type == 'unary_expression':
+            fields = ('argument',)
+        elif node_type == 'binary_expression':
+            fields = ('left', 'right')
+        else:
+            return []
+        return [operand for operand in map(node.child_by_field_name, fields) if operand is not None]
+
+    def evaluate(self, node, sizes):
+        """(int value, bytes it takes minified) of one node, its operands
+        already evaluated by constant()"""
+        node_type = node.type
+        if node_type == 'number_literal':
+            text = self.text(node)
+            match = INTEGER.fullmatch(text)
+            if not match or match.group(2):
+                raise NotConstant  # suffixed: not of type int
+            value, text = shorten_integer(text)
+            if value > INT_MAX:
+                raise NotConstant
+            return value, len(text)
+        if node_type == 'sizeof_expression':
+            type_node = node.child_by_field_name('type')
+            if not sizes or type_node is None or b' '.join(self.text(type_node).split()) not in CHAR_TYPES:
+                raise NotConstant
+            return 1, len(b'sizeof(') + len(self.text(type_node)) + 1
+        if node_type not in ('parenthesized_expression', 'unary_expression', 'binary_expression'):
+            raise NotConstant
+        operands = self.operands(node)
+        values = self.values[sizes]
+        results = [values[(operand.start_byte, operand.end_byte)] for operand in operands]
+        if not results or None in results:
+            raise NotConstant
+        if node_type == 'parenthesized_expression':
+            value, cost = results[0]
+            return value, cost + 2
+        operator = node.child_by_field_name('operator').type
+        if node_type == 'unary_expression':
+            value, cost = results[0]
+            if operator == '-':
+                value = -value
+            elif operator == '~':
+                value = ~value
+            elif operator == '!':
+                value = int(not value)
+            elif operator != '+':
+                raise NotConstant
+            return check(value), cost + 1
+        if len(results) != 2:
+            raise NotConstant
+        (left, left_cost), (right, right_cost) = results
+        return check(binary(operator, left, right)), left_cost + right_cost + len(operator)
+
+
+def check(value):
+    """value, if an int can hold it"""
+    if not INT_MIN <= value <= INT_MAX:
+        raise NotConstant  # signed overflow is undefined
+    return value
+
+
+def binary(operator, left, right):
+    """C semantics of a binary operator on two ints"""
+    if operator == '+':
+        return left + right
+    if operator == '-':
+        return left - right
+    if operator == '*':
+        return left * right
+    if operator in ('/', '%'):
+        if right == 0:
+            raise NotConstant
+        quotient = abs(left) // abs(right)
+        if (left < 0) != (right < 0):
+            quotient = -quotient  # C truncates toward zero
+        return quotient if operator == '/' else left - right * quotient
+    if operator in ('<<', '>>'):
+        if left < 0 or not 0 <= right < 31:
+            raise NotConstant  # negative operands are undefined or implementation-defined
+        return left << right if operator == '<<' else left >> right
+    if operator == '&':
+        return left & right
+    if operator == '|':
+        return left | right
+    if operator == '^':
+        return left ^ right
+    if operator == '&&':
+        return int(bool(left and right))
+    if operator == '||':
+        return int(bool(left or right))
+    comparisons = {'<': left < right, '>': left > right, '<=': left <= right,
+                   '>=': left >= right, '==': left == right, '!=': left != right}
+    if operator in comparisons:
+        return int(comparisons[operator])
+    raise NotConstant
+
+
+def compact_literals(minifier):
+    """Rewrites for a CMinifier, as LiteralCompactor.compact() returns them"""
+    return LiteralCompactor(minifier).compact()
+
+
+def main(argv=None):
+    argv = sys.argv[1:] if argv is None else argv
+    if len(argv) != 1:
+        print("Usage: python3 literals.py <file.c>", file=sys.stderr)
+        return 1
+    minifier = minify.CMinifier(minify.read_source(argv[0]))
+    minifier.walk()
+    source_bytes = minifier.source_bytes
+    saved = 0
+    for (start, end), (text, _) in sorted(compact_literals(minifier).items()):
+        saved += end - start - len(text)
+        line = source_bytes.count(b'\n', 0, start) + 1
+        print(f"{line}: {bytes(source_bytes[start:end]).decode('utf-8', 'replace')} -> "
+              f"{text.decode('utf-8', 'replace')}")
+    print(f"{saved} bytes saved", file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -8,15 +8,23 @@ This tool minifies C code by:
 3. Renaming local variables, function parameters, and static globals
 """
 
+import mmap
+import os
+import re
 import sys
+import threading
+from array import array
 import tree_sitter_c as tsc
 from tree_sitter import Language, Parser, Node
 
 # Configuration
 ENABLE_RENAMING = True
 
-# C Keywords that should never be renamed
-KEYWORDS = {
+# Bump when the output for a given input changes (part of the result cache key)
+MINIFIER_VERSION = '2.5'
+
+# C Keywords that should never be renamed (names are compared as bytes)
+KEYWORDS = {name.encode('ascii') for name in {
     # C89/C90 keywords
     'auto', 'break', 'case', 'char', 'const', 'continue', 'default', 'do',
     'double', 'else', 'enum', 'extern', 'float', 'for', 'goto', 'if',
@@ -29,16 +37,120 @@ KEYWORDS = {
     '_Thread_local', '_Generic',
     # Common reserved identifiers
     'main',
-}
+}}
+
+
+# Nodes that open a new renaming scope
+SCOPE_TYPES = {'function_definition', 'compound_statement', 'for_statement'}
+# Members of these are never renamed
+PROTECTED_TYPES = {'struct_specifier', 'union_specifier', 'enum_specifier'}
+# Declarations whose 'declarator' children introduce names
+DECLARATION_TYPES = {'declaration', 'field_declaration', 'type_definition'}
+# Declarator wrappers that pass the name through their 'declarator' field
+POINTER_LIKE_DECLARATORS = {'pointer_declarator', 'array_declarator', 'attributed_declarator'}
+# Preprocessor nodes naming macros rather than C variables
+PREPROC_PROTECTED_TYPES = {'preproc_def', 'preproc_function_def', 'preproc_call',
+                           'preproc_include', 'preproc_defined'}
+
+# Context flags carried down the AST walk, one value per open node
+CTX_PROTECTED = 1       # never rename (struct/union/enum bodies, members, macros)
+CTX_DECLARATOR = 2      # an identifier here is the name being declared
+CTX_FUNCTION_NAME = 4   # ...and it names a function
+CTX_STATIC = 8          # the enclosing declaration is 'static'
+CTX_EXTERN = 16         # the enclosing declaration is 'extern'
+CTX_FILE_SCOPE = 32     # outside any function body
+CTX_FUNCTION_DEF = 64   # declarator chain of a function_definition
+CTX_PARAMS_DEF = 128    # parameter list of the function being defined
+# Flags every child inherits; the rest only flow along declarator chains
+CTX_INHERITED = CTX_PROTECTED | CTX_FILE_SCOPE
+
+# Identifier events recorded during the AST walk
+EV_ENTER = 0        # (EV_ENTER,)
+EV_EXIT = 1         # (EV_EXIT,)
+EV_DECL_STATIC = 2  # (kind, start_byte, end_byte, name) static global declaration
+EV_DECL_LOCAL = 3   # local variable or parameter declaration
+EV_DECL_KEEP = 4    # block-scope extern/prototype: shadows outer renames, keeps its name
+EV_USE = 5          # usage, resolved through the scope chain
+EV_FIXED = 6        # (kind, start_byte, end_byte, text) replacement settled by the walk
+
+# Byte values that join into one token with their neighbours: ASCII letters,
+# digits, '_' and any non-ASCII byte (UTF-8 identifiers, Latin-1 text)
+WORD_BYTES = frozenset(
+    b'abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_' + bytes(range(0x80, 0x100)))
+
+# Byte pairs that lex as one longer token (or start a comment) when written
+# together, including the digraphs
+MERGING_PAIRS = frozenset({
+    b'++', b'--', b'+=', b'-=', b'->', b'&&', b'&=', b'||', b'|=', b'<<', b'<=',
+    b'>>', b'>=', b'==', b'!=', b'*=', b'/=', b'%=', b'^=', b'/*', b'//', b'##',
+    b'..', b'<:', b'<%', b'%>', b'%:', b':>',
+})
+# Identifiers that turn a following string or char literal into a wide one
+STRING_PREFIXES = frozenset({b'L', b'u', b'U', b'u8'})
+# Backslash-newline: two physical lines spliced into one
+LINE_SPLICE = re.compile(rb'\\\r?\n')
+# Pieces of a macro body: literals, comments, whitespace, runs of anything else
+MACRO_PIECE = re.compile(rb'''"(?:[^"\\\n]|\\.)*"|'(?:[^'\\\n]|\\.)*'|/\*.*?\*/|//[^\n]*'''
+                         rb'''|\s+|[^\s"'/]+|.''', re.S)
+# Trailing run of a piece that may be (part of) an identifier or pp-number
+TRAILING_WORD = re.compile(rb'[A-Za-z0-9_.]+\Z')
+# Preprocessing tokens of a piece: pp-numbers, identifiers, single bytes
+PP_TOKEN = re.compile(rb'\.?[0-9](?:[eEpP][+-]|[A-Za-z0-9_.])*|[A-Za-z_\x80-\xff][A-Za-z0-9_\x80-\xff]*|.',
+                      re.S)
+# Directives that start a conditional group, by the directive continuing one
+OPENING_DIRECTIVES = {'#elif': b'#if', '#elifdef': b'#ifdef', '#elifndef': b'#ifndef'}
+# Initializer lists at least this large are tried as one bulk token
+BULK_BYTES = 1 << 12
+# Tokens of a literal-only initializer list: braces, commas, signs, gaps,
+# numbers, strings and chars; a list is literal-only if nothing else is left
+LIST_ATOM = re.compile(rb"""[\s{},+\-]+|/\*.*?\*/|//[^\n]*|\.?[0-9](?:[eEpP][+-]|[A-Za-z0-9_.])*"""
+                       rb"""|(?:u8|[LuU])?"(?:[^"\\\n]|\\.)*"|[LuU]?'(?:[^'\\\n]|\\.)*'""", re.S)
+# Bytes of a list of bare numbers, and a map of them to their classes:
+# separators to ' ', digits and '.' to '0', the rest to 'a'; a word byte
+# right after a separator that is not a digit starts an identifier
+NUMBER_LIST_BYTES = b' \t\n\r\f\v{},+-.' + bytes(sorted(WORD_BYTES))
+NUMBER_LIST_CLASSES = bytes(
+    0x20 if byte in b' \t\n\r\f\v{},+-' else 0x30 if byte in b'0123456789.' else 0x61
+    for byte in range(256))
+LIST_LITERAL_OR_GAP = re.compile(rb"""((?:u8|[LuU])?"(?:[^"\\\n]|\\.)*"|[LuU]?'(?:[^'\\\n]|\\.)*')"""
+                                 rb"""|(?:\s|/\*.*?\*/|//[^\n]*)+""", re.S)
+LIST_LITERAL_OR_COMMENT = re.compile(rb"""((?:u8|[LuU])?"(?:[^"\\\n]|\\.)*"|[LuU]?'(?:[^'\\\n]|\\.)*')"""
+                                     rb"""|/\*.*?\*/|//[^\n]*""", re.S)
+# How allocate_region() orders the bindings it names: most referenced first
+# (fewest raw bytes), or in declaration order, so functions of the same
+# shape come out as the same bytes (what a compressor matches best)
+NAME_ORDERS = ('uses', 'declaration')
+# Extensions of headers: their top-level statics are never dead code
+HEADER_EXTENSIONS = ('.h',)
+# Single-file options that switch on an extra pass
+PASS_OPTIONS = {'--remove-dead-code', '--compact-literals', '--verify'}
+# Bytes a streaming TokenEmitter buffers before handing them to its sink
+OUTPUT_BUFFER_SIZE = 1 << 16
+
+# Short names by index; extended under the lock past the precomputed ones
+SHORT_NAMES = []
+_short_names_lock = threading.Lock()
+
+# Nodes emitted verbatim instead of descending into their tokens
+ATOMIC_TYPES = {'string_literal', 'char_literal', 'raw_string_literal', 'system_lib_string'}
+
+
+def short_name(index):
+    """generate_short_name(index), cached"""
+    if index >= len(SHORT_NAMES):
+        with _short_names_lock:
+            while len(SHORT_NAMES) <= index:
+                SHORT_NAMES.append(generate_short_name(len(SHORT_NAMES)))
+    return SHORT_NAMES[index]
 
 
 def generate_short_name(index):
     """Generate short variable names: a, b, ..., z, A, ..., Z, aa, ab, ..."""
-    chars = 'abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ'
+    chars = b'abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ'
     base = len(chars)
-    name = ''
+    name = b''
     while True:
-        name = chars[index % base] + name
+        name = chars[index % base:index % base + 1] + name
         index //= base
         if index == 0:
             break
@@ -46,26 +158,50 @@ def generate_short_name(index):
     return name
 
 
+# Every one- and two-letter name, generated once at import
+SHORT_NAMES.extend(generate_short_name(i) for i in range(52 + 52 * 52))
+
+
+class NameSequence:
+    """The short names in order with the reserved ones left out
+    
+    Built once per set of reserved names, so allocation indexes straight
+    into it instead of generating names and testing each against the
+    reserved set.
+    """
+    def __init__(self, reserved):
+        self.reserved = reserved
+        self.names = []
+        self.scanned = 0  # SHORT_NAMES entries considered so far
+    
+    def __getitem__(self, index):
+        names = self.names
+        while len(names) <= index:
+            name = short_name(self.scanned)
+            self.scanned += 1
+            if name not in self.reserved:
+                names.append(name)
+        return names[index]
+
+
 class Scope:
-    """Represents a variable scope with renaming mappings"""
-    def __init__(self, is_protected=False):
+    """The file scope: static globals and their short names
+    
+    Statics are named in declaration order, so the scope after a run of
+    declarations depends only on the statics they declare.
+    """
+    def __init__(self):
         self.mappings = {}  # original_name -> new_name
-        self.counter = 0
-        self.is_protected = is_protected  # Don't rename in struct/union/enum
-        
-    def add_variable(self, name, reserved_names=None):
-        """Add a variable to this scope and generate a short name"""
-        if reserved_names is None:
-            reserved_names = KEYWORDS
-        
-        if name in self.mappings or name in reserved_names:
-            return self.mappings.get(name, name)
-        
-        new_name = generate_short_name(self.counter)
-        while new_name in reserved_names:
-            self.counter += 1
-            new_name = generate_short_name(self.counter)
+        self.counter = 0  # next index into the NameSequence
         
+    def add_variable(self, name, names):
+        """Name a static global from names (a NameSequence); reserved names stay"""
+        if name in self.mappings:
+            # A tentative definition seen again, or a name preset by the caller
+            return self.mappings[name]
+        if name in names.reserved:
+            return name
+        new_name = names[self.counter]
         self.counter += 1
         self.mappings[name] = new_name
         return new_name
@@ -75,409 +211,1103 @@ class Scope:
         return self.mappings.get(name)
 
 
-class CMinifier:
-    def __init__(self, source_code):
-        self.source = source_code
-        self.source_bytes = source_code.encode('utf-8')
-        
-        # Initialize tree-sitter
-        self.language = Language(tsc.language())
-        self.parser = Parser(self.language)
-        self.tree = self.parser.parse(self.source_bytes)
-        
-        # Function name collection
-        self.function_names = set()
-        
-        # Scope management
-        self.scopes = [Scope()]  # Global scope
-        self.current_scope_idx = 0
-        
-        # Track what to keep/remove
-        self.removals = []  # List of (start_byte, end_byte) to remove
-        self.replacements = {}  # byte_offset -> new_text
-        
-    def get_node_text(self, node):
-        """Get the text content of a node"""
-        return self.source_bytes[node.start_byte:node.end_byte].decode('utf-8')
-    
-    def get_function_name_from_declarator(self, declarator):
-        """Extract function name from a declarator node"""
-        # Handle different declarator types
-        if declarator.type == 'identifier':
-            return self.get_node_text(declarator)
-        elif declarator.type == 'function_declarator':
-            # Recursively get the declarator inside
-            inner = declarator.child_by_field_name('declarator')
-            if inner:
-                return self.get_function_name_from_declarator(inner)
-        elif declarator.type == 'pointer_declarator':
-            # Function pointer: int (*func)(...)
-            inner = declarator.child_by_field_name('declarator')
-            if inner:
-                return self.get_function_name_from_declarator(inner)
-        elif declarator.type == 'parenthesized_declarator':
-            # Parenthesized: (func)
-            for child in declarator.children:
-                if child.type == 'identifier':
-                    return self.get_node_text(child)
-                elif child.type in ('function_declarator', 'pointer_declarator'):
-                    return self.get_function_name_from_declarator(child)
-        return None
+class Binding:
+    """One local declaration of a function body, for allocate_region()"""
+    __slots__ = ('name', 'serial', 'new_name', 'uses', 'neighbors', 'forbidden', 'checked')
     
-    def collect_function_names(self, node):
-        """Recursively collect all function names from the AST"""
-        if node.type == 'function_definition':
-            # Get function name from declarator
-            declarator = node.child_by_field_name('declarator')
-            if declarator:
-                func_name = self.get_function_name_from_declarator(declarator)
-                if func_name:
-                    self.function_names.add(func_name)
-        
-        elif node.type == 'declaration':
-            # Function declaration (prototype): int foo();
-            # Check if this is a function declaration by looking for function_declarator
-            for child in node.children:
-                if child.type == 'function_declarator' or self.has_function_declarator(child):
-                    declarator = child
-                    if declarator.type == 'init_declarator':
-                        declarator = declarator.child_by_field_name('declarator')
-                    if declarator:
-                        func_name = self.get_function_name_from_declarator(declarator)
-                        if func_name:
-                            self.function_names.add(func_name)
-        
-        # Recursively process children
-        for child in node.children:
-            self.collect_function_names(child)
+    def __init__(self, name, serial, new_name=None):
+        self.name = name
+        self.serial = serial  # declaration order within the function
+        self.new_name = new_name  # preset for bindings that keep their name
+        self.uses = 0  # references, the declaration included
+        self.neighbors = []  # renamed bindings that must get another name
+        self.forbidden = set()  # fixed names visible at its references
+        self.checked = serial  # newest serial already linked to it
     
-    def has_function_declarator(self, node):
-        """Check if a node contains a function_declarator"""
-        if node.type == 'function_declarator':
-            return True
-        for child in node.children:
-            if self.has_function_declarator(child):
-                return True
-        return False
+    def interfere(self, inner):
+        """Record that inner is visible at one of this binding's references"""
+        if self.new_name is None:
+            if inner.new_name is None:
+                self.neighbors.append(inner)
+                inner.neighbors.append(self)
+            else:
+                self.forbidden.add(inner.new_name)
+        elif inner.new_name is None:
+            inner.forbidden.add(self.new_name)
+
+
+class EditList:
+    """Source edits in increasing byte order, as compact parallel arrays
+    
+    Edit i replaces bytes [starts[i], starts[i] + lengths[i]) with
+    names[name_ids[i]]. Replacement names are interned, so an edit costs
+    16 bytes of array storage instead of a dict entry and a tuple, and
+    consumers apply the edits in one forward sweep without sorting.
+    """
+    __slots__ = ('starts', 'lengths', 'name_ids', 'names', 'name_index')
+    
+    def __init__(self):
+        self.starts = array('q')
+        self.lengths = array('I')
+        self.name_ids = array('I')
+        self.names = []  # distinct replacement texts
+        self.name_index = {}  # replacement text -> its index in names
+    
+    def append(self, start, end, name):
+        """Add an edit; start must not precede the last edit's"""
+        name_id = self.name_index.get(name)
+        if name_id is None:
+            name_id = self.name_index[name] = len(self.names)
+            self.names.append(name)
+        self.starts.append(start)
+        self.lengths.append(end - start)
+        self.name_ids.append(name_id)
+    
+    def __len__(self):
+        return len(self.starts)
+    
+    def __iter__(self):
+        """(start, end, replacement) of every edit, in order"""
+        names = self.names
+        for start, length, name_id in zip(self.starts, self.lengths, self.name_ids):
+            yield start, start + length, names[name_id]
     
-    def is_comment(self, node):
-        """Check if node is a comment"""
-        return node.type == 'comment'
+    def shifted(self, delta):
+        """A copy with every offset moved by delta"""
+        edits = EditList()
+        edits.starts = array('q', [start + delta for start in self.starts])
+        edits.lengths = array('I', self.lengths)
+        edits.name_ids = array('I', self.name_ids)
+        edits.names = list(self.names)
+        edits.name_index = dict(self.name_index)
+        return edits
     
-    def is_struct_union_enum_specifier(self, node):
-        """Check if we're in a struct/union/enum definition"""
-        if node.type in ('struct_specifier', 'union_specifier', 'enum_specifier'):
+    def saved_bytes(self):
+        """Source bytes removed net of the replacement texts"""
+        sizes = [len(name) for name in self.names]
+        return sum(self.lengths) - sum(sizes[name_id] for name_id in self.name_ids)
+
+
+def needs_separator(prev, prev_number, token):
+    """True if writing token right after prev would change how they lex"""
+    last = prev[-1]
+    first = token[0]
+    if last in WORD_BYTES:
+        if first in WORD_BYTES:
             return True
-        if node.parent:
-            return self.is_struct_union_enum_specifier(node.parent)
+        if first in b'"\'':
+            return prev in STRING_PREFIXES
+    # pp-numbers absorb '.', and '+'/'-' after an exponent: 1e +1, 0x1p -3
+    if prev_number and (first == 0x2e or (first in b'+-' and last in b'eEpP')):
+        return True
+    if last == 0x2e and first in b'0123456789':
+        return True
+    return prev[-1:] + token[:1] in MERGING_PAIRS
+
+
+def compact_macro_body(text):
+    """Body of a #define with continuations joined, comments dropped and only
+    the whitespace that keeps tokens apart; text itself if it does not lex"""
+    if b'\\' in text:
+        text = LINE_SPLICE.sub(b'', text)
+    out = []
+    gap = False
+    for piece in MACRO_PIECE.findall(text):
+        first = piece[0]
+        if piece.isspace() or piece[:2] in (b'/*', b'//'):
+            gap = True
+            continue
+        if first in b'"\'' and (len(piece) < 2 or piece[-1] != first):
+            return text  # unterminated quote: leave the body alone
+        if gap and out:
+            prev = out[-1]
+            word = TRAILING_WORD.search(prev)
+            if word:
+                prev = word.group()
+            # Any digit may belong to a pp-number, which '.' or '+' extends
+            if needs_separator(prev, word is not None and any(c in b'0123456789' for c in prev), piece):
+                out.append(b' ')
+        out.append(piece)
+        gap = False
+    return b''.join(out)
+
+
+def rename_macro_parameters(params, body, source_bytes):
+    """EV_FIXED events giving a function-like macro's parameters short names
+    
+    Parameters are local to the body, so they only have to stay clear of
+    the other identifiers there. Identifiers inside literals are not
+    parameters, while operands of '#' and '##' are, and they are renamed
+    alike: both operators act on the argument, never on the parameter's
+    spelling.
+    """
+    parameters = [child for child in params.children if child.type == 'identifier']
+    names = [source_bytes[p.start_byte:p.end_byte] for p in parameters]
+    if not names or len(set(names)) != len(names):
+        return []
+    text = source_bytes[body.start_byte:body.end_byte] if body is not None else b''
+    if b'\\' in text:
+        text = LINE_SPLICE.sub(b'', text)
+    
+    uses = dict.fromkeys(names, 0)
+    others = set(KEYWORDS)  # every identifier of the body that is not a parameter
+    tokens = []  # (start, end, name) of the parameter references in text
+    for piece in MACRO_PIECE.finditer(text):
+        word = piece.group()
+        first = word[0]
+        if first in b'"\'':
+            if len(word) < 2 or word[-1] != first:
+                return []  # unterminated quote: not a body we can lex
+            continue
+        if word.isspace() or word[:2] in (b'/*', b'//'):
+            continue
+        for token in PP_TOKEN.finditer(word):
+            name = token.group()
+            if name[0] not in WORD_BYTES or name[0] in b'0123456789':
+                continue  # a pp-number or punctuator
+            if (token.end() == len(word) and name in STRING_PREFIXES
+                    and text[piece.end():piece.end() + 1] in (b'"', b"'")):
+                continue  # L"...": part of the literal
+            if name in uses:
+                uses[name] += 1
+                tokens.append((piece.start() + token.start(), piece.start() + token.end(), name))
+            else:
+                others.add(name)
+    
+    # Most used first, each with the shortest name free in this body
+    renames = {}
+    index = 0
+    for name in sorted(names, key=lambda name: -uses[name]):
+        while short_name(index) in others:
+            index += 1
+        renames[name] = short_name(index)
+        index += 1
+    
+    events = [(EV_FIXED, p.start_byte, p.end_byte, renames[name])
+              for p, name in zip(parameters, names) if renames[name] != name]
+    if any(renames[name] != name for _, _, name in tokens):
+        out = []
+        pos = 0
+        for start, end, name in tokens:
+            out.append(text[pos:start])
+            out.append(renames[name])
+            pos = end
+        out.append(text[pos:])
+        events.append((EV_FIXED, body.start_byte, body.end_byte, b''.join(out)))
+    return events
+
+
+def is_literal_list(text):
+    """True if an initializer list holds nothing but literals, braces and signs"""
+    # A line splice could continue a // comment: leave those to the AST
+    return b'\\\n' not in text and b'\\\r' not in text and not LIST_ATOM.sub(b'', text)
+
+
+def list_comments(source_bytes, start, end):
+    """(start, end) of each comment in the literal-only list source_bytes[start:end]"""
+    text = source_bytes[start:end]
+    if b'/' not in text:
+        return []
+    return [(start + match.start(), start + match.end())
+            for match in LIST_LITERAL_OR_COMMENT.finditer(text) if match.group(1) is None]
+
+
+def list_gap(text, start, end):
+    """What the gap text[start:end] between two list tokens compacts to"""
+    # Only numbers end in a word byte or '.' inside a literal-only list
+    prev = text[start - 1:start]
+    prev_number = prev[0] in WORD_BYTES or prev == b'.'
+    return b' ' if needs_separator(prev, prev_number, text[end:end + 1]) else b''
+
+
+def compact_literal_list(text):
+    """A literal-only initializer list without comments and needless whitespace
+    
+    Produces what emitting its nodes one by one would, in a few passes of
+    the regex engine instead of Python code per node. None if the list
+    holds anything besides literals.
+    """
+    if not text.translate(None, NUMBER_LIST_BYTES):
+        # Bare numbers, the common shape of generated tables: bytes methods
+        # only, a regex match per number would dominate the run time
+        if b' a' in b' ' + text.translate(NUMBER_LIST_CLASSES):
+            return None
+        text = b' '.join(text.split())
+        for punctuator in (b'{', b'}', b','):
+            text = text.replace(b' ' + punctuator, punctuator).replace(punctuator + b' ', punctuator)
+        if b' ' in text:
+            text = re.sub(rb' ', lambda gap: list_gap(gap.string, gap.start(), gap.end()), text)
+        return text
+    if not is_literal_list(text):
+        return None
+    return LIST_LITERAL_OR_GAP.sub(
+        lambda match: match.group(1) or list_gap(match.string, match.start(), match.end()), text)
+
+
+def conditional_plan(node, source_bytes):
+    """What to write of an #if chain without its '#if 0' branches or what
+    follows an '#if 1': a list of (node, text, node_type), where text is
+    None for a subtree written as it is and otherwise replaces a directive
+
+    None if no condition is a constant.
+    """
+    branches = []  # [node, constant value or None]
+    branch = node
+    while branch is not None:
+        if branch.type == 'preproc_else':
+            value = True
+        else:
+            value = constant_condition(branch.child_by_field_name('condition'), source_bytes)
+        branches.append((branch, value))
+        branch = branch.child_by_field_name('alternative')
+    if all(value is None for branch, value in branches if branch.type != 'preproc_else'):
+        return None
+    
+    plan = []
+    opened = False  # an #if is written and awaits its #endif
+    for branch, value in branches:
+        if value is False:
+            continue
+        children = branch.children
+        alternative = branch.child_by_field_name('alternative')
+        if value is True and not opened:
+            # Always taken and nothing before it: just its contents
+            condition = branch.child_by_field_name('condition')
+            for child in children[1:]:
+                if child == alternative:
+                    break
+                if child != condition and child.type not in ('\n', '#endif'):
+                    plan.append((child, None, None))
+            return plan
+        directive = children[0]
+        if value is True:
+            # An '#elif 1' or '#else' after a kept branch ends the chain
+            plan.append((directive, b'#else', '#else'))
+            condition = branch.child_by_field_name('condition')
+            children = [child for child in children[1:] if child != condition]
+        elif not opened and directive.type in OPENING_DIRECTIVES:
+            # The kept branch is now the first: '#elif X' becomes '#if X'
+            plan.append((directive, OPENING_DIRECTIVES[directive.type], '#if'))
+            children = children[1:]
+        opened = True
+        for child in children:
+            if child == alternative:
+                break
+            if child.type != '#endif':
+                plan.append((child, None, None))
+        if value is True:
+            break
+    if opened:
+        for child in reversed(node.children):
+            if child.type == '#endif':
+                plan.append((child, None, None))
+                break
+    return plan
+
+
+def dropped_branches(node, source_bytes):
+    """(start, end) of the children of an #if chain its conditional_plan() leaves out
+    
+    walk() passes over them, so a dead branch records no identifiers.
+    """
+    plan = conditional_plan(node, source_bytes)
+    if plan is None:
+        return ()
+    kept = {(child.start_byte, child.end_byte) for child, text, _ in plan if text is None}
+    dropped = []
+    branch = node
+    while branch is not None:
+        alternative = branch.child_by_field_name('alternative')
+        for child in branch.children:
+            key = (child.start_byte, child.end_byte)
+            if child != alternative and key not in kept:
+                dropped.append(key)
+        branch = alternative
+    return dropped
+
+
+def constant_condition(node, source_bytes):
+    """True/False for an '#if 1'/'#if 0' condition, None if it is not that simple"""
+    if node is None or node.type != 'number_literal':
+        return None
+    text = source_bytes[node.start_byte:node.end_byte]
+    if text == b'0':
         return False
+    if text == b'1':
+        return True
+    return None
+
+
+def ends_line(gap):
+    """True if the bytes between two tokens hold a newline not escaped by '\\'"""
+    return b'\n' in gap.replace(b'\\\r\n', b'').replace(b'\\\n', b'')
+
+
+class TokenEmitter:
+    """Writes the leaf tokens of AST subtrees with as few separators as possible
+    
+    Comments are dropped and renames applied as tokens go by. Tokens are
+    separated only where they would otherwise merge, and directives get a
+    line of their own. Successive emit() calls on consecutive subtrees
+    continue the same output.
+    
+    Without a sink the output is kept for getvalue(). With one (a callable
+    taking bytes, or an object with write()), output is handed over in
+    chunks of about buffer_size bytes, so memory stays flat however large
+    the output grows; call flush() at the end.
+    """
+    def __init__(self, source_bytes, edits, sink=None, buffer_size=OUTPUT_BUFFER_SIZE, skip=None,
+                 folded=None):
+        self.source_bytes = source_bytes
+        self.edits = edits  # EditList of renames, consumed in order
+        self.next_edit = 0  # index of the first edit not yet passed
+        self.skip = skip  # (start_byte, end_byte) of subtrees left out entirely
+        self.folded = folded  # (start_byte, end_byte) -> (text, node_type) written as one token
+        self.sink = getattr(sink, 'write', sink)
+        self.buffer_size = buffer_size
+        self.out = []
+        self.buffered = 0  # bytes in out
+        self.written = 0  # bytes handed to the sink so far
+        self.prev = b''  # last token written
+        self.prev_number = False  # ...and whether it was a number literal
+        self.prev_end = 0  # source end of the last leaf seen, comments included
+        self.in_directive = False  # inside a directive line not yet ended
+        self.newline_pending = False  # a directive line ended before the next token
+        self.head = None  # first token written, and whether it starts a directive
     
-    def find_comments(self, node):
-        """Recursively find all comments in the AST"""
-        if self.is_comment(node):
-            self.removals.append((node.start_byte, node.end_byte))
+    def emit(self, node):
+        """Write every token of the subtree rooted at node"""
+        cursor = node.walk()
+        skip = self.skip
+        folded = self.folded
+        while True:
+            node = cursor.node
+            if skip and (node.start_byte, node.end_byte) in skip:
+                pass  # dropped subtree: none of its tokens are written
+            elif folded and (node.start_byte, node.end_byte) in folded:
+                self.leaf(node, *folded[node.start_byte, node.end_byte])
+            elif node.type == 'preproc_if' and self.conditional(node):
+                pass  # written branch by branch, dead ones left out
+            elif (node.type == 'initializer_list' and node.end_byte - node.start_byte >= BULK_BYTES
+                    and self.literal_list(node)):
+                pass  # generated data: compacted in bulk
+            elif node.type not in ATOMIC_TYPES and cursor.goto_first_child():
+                continue
+            else:
+                self.leaf(node)
+            while not cursor.goto_next_sibling():
+                if not cursor.goto_parent():
+                    return
+    
+    def conditional(self, node):
+        """Write an #if chain without its '#if 0' branches or what follows an '#if 1'
         
-        for child in node.children:
-            self.find_comments(child)
+        Returns False, writing nothing, if no condition is a constant.
+        """
+        plan = conditional_plan(node, self.source_bytes)
+        if plan is None:
+            return False
+        for child, text, node_type in plan:
+            if text is None:
+                self.emit(child)
+            else:
+                self.leaf(child, text, node_type)
+        return True
     
-    def is_declaration(self, node):
-        """Check if an identifier is part of a declaration"""
-        if not node.parent:
+    def literal_list(self, node):
+        """Write a literal-only initializer list as one token; False if it is not one"""
+        text = compact_literal_list(self.source_bytes[node.start_byte:node.end_byte])
+        if text is None:
             return False
+        self.leaf(node, text, 'initializer_list')
+        return True
+    
+    def leaf(self, node, text=None, node_type=None):
+        """Write one token: node's text, renamed, or text standing for the whole node"""
+        start, end = node.start_byte, node.end_byte
+        if start == end:
+            return  # MISSING node inserted by error recovery
+        if self.in_directive and ends_line(self.source_bytes[self.prev_end:start]):
+            self.in_directive = False
+            self.newline_pending = True
+        self.prev_end = end
         
-        parent = node.parent
-        
-        # Direct declarator in a declaration
-        if parent.type == 'init_declarator':
-            return True
-        if parent.type == 'declarator':
-            # Check if this declarator is part of a declaration
-            p = parent.parent
-            while p:
-                if p.type in ('declaration', 'parameter_declaration', 'field_declaration'):
-                    return True
-                p = p.parent
-        
-        # Parameter declaration
-        if parent.type == 'parameter_declaration':
-            return True
-            
-        # Field declaration (struct member)
-        if parent.type == 'field_declaration':
-            return True
+        if text is None:
+            node_type = node.type
+            if node_type == 'comment':
+                return
+            # Leaves arrive in source order, so the edits are one forward sweep
+            starts = self.edits.starts
+            i = self.next_edit
+            while i < len(starts) and starts[i] < start:
+                i += 1
+            if i < len(starts) and starts[i] == start:
+                edits = self.edits
+                text = edits.names[edits.name_ids[i]]
+                i += 1
+            else:
+                text = self.source_bytes[start:end]
+            self.next_edit = i
+        if node_type == 'preproc_arg':
+            if node.parent.type in ('preproc_def', 'preproc_function_def'):
+                text = compact_macro_body(text)
+            else:
+                text = text.rstrip(b' \t')
+        elif text.isspace():
+            # The newline token closing a directive
+            if self.in_directive and b'\n' in text:
+                self.in_directive = False
+                self.newline_pending = True
+            return
+        if not text:
+            return
         
-        return False
+        directive = node_type[0] == '#' or node_type == 'preproc_directive'
+        out = self.out
+        if self.head is None:
+            self.head = (text, directive)
+        else:
+            if directive or self.newline_pending:
+                out.append(b'\n')
+            elif (node_type == 'preproc_arg' and node.parent.type != 'preproc_function_def'
+                    or needs_separator(self.prev, self.prev_number, text)):
+                # An object-like macro's body is always set off from its
+                # name: '#define X (1)'; 'f(x)(x)' needs nothing after ')'
+                out.append(b' ')
+        self.newline_pending = False
+        out.append(text)
+        self.buffered += len(text) + 1
+        if self.sink is not None and self.buffered >= self.buffer_size:
+            self.flush()
+        self.prev = text
+        self.prev_number = node_type == 'number_literal'
+        if directive:
+            self.in_directive = True
     
-    def is_member_access(self, node):
-        """Check if identifier is a struct/union member access"""
-        if not node.parent:
-            return False
+    def finish(self, end=None):
+        """Account for the gap after the last token (up to end, default EOF)"""
+        if end is None:
+            end = len(self.source_bytes)
+        if self.in_directive and ends_line(self.source_bytes[self.prev_end:end]):
+            self.in_directive = False
+            self.newline_pending = True
+    
+    def flush(self):
+        """Hand everything buffered to the sink"""
+        if self.out:
+            chunk = b''.join(self.out)
+            self.sink(chunk)
+            self.written += len(chunk)
+            self.out.clear()
+        self.buffered = 0
+    
+    def getvalue(self):
+        return b''.join(self.out)
+
+
+def read_source(path):
+    """Contents of a source file as a bytes-like object, memory-mapped unless empty"""
+    with open(path, 'rb') as f:
+        if os.fstat(f.fileno()).st_size == 0:
+            return b''
+        # The mapping stays valid after the file is closed
+        return mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+
+# The tree-sitter language is shared; parsers are not thread-safe, so each
+# thread creates its own on first use and reuses it for every file
+_language = None
+_language_lock = threading.Lock()
+_thread_state = threading.local()
+
+
+def get_language():
+    """Return the shared tree-sitter C language, creating it on first use"""
+    global _language
+    if _language is None:
+        with _language_lock:
+            if _language is None:
+                _language = Language(tsc.language())
+    return _language
+
+
+def get_parser():
+    """Return the calling thread's C parser, creating it on first use"""
+    parser = getattr(_thread_state, 'parser', None)
+    if parser is None:
+        parser = _thread_state.parser = Parser(get_language())
+    return parser
+
+
+class CMinifier:
+    def __init__(self, source_code, parser=None, enable_renaming=None, tree=None,
+                 project_names=None, remove_dead_code=False, compact_literals=False,
+                 name_order='uses', header=False):
+        """source_code is bytes (or any buffer, e.g. an mmap); str is encoded as UTF-8
         
-        parent = node.parent
+        project_names maps external symbols to the short names a project
+        index gave them (see project.py); they are renamed everywhere,
+        declarations included. remove_dead_code drops unreferenced static
+        definitions and unused locals (see deadcode.py); compact_literals
+        folds constants and shortens literals (see literals.py).
+        name_order is one of NAME_ORDERS: which locals get the shortest
+        names first (see allocate_region()). header marks the source as a
+        header, whose top-level statics every includer may use, so dead
+        code removal keeps them.
+        """
+        self.source = source_code
+        if isinstance(source_code, str):
+            source_code = source_code.encode('utf-8')
+        # Never decoded: names, spans and output all stay bytes, so any
+        # ASCII-compatible encoding passes through untouched
+        self.source_bytes = source_code
+        # Per-instance override of the module-level ENABLE_RENAMING setting
+        self.enable_renaming = ENABLE_RENAMING if enable_renaming is None else enable_renaming
+        self.remove_dead_code = remove_dead_code
+        self.compact_literals = compact_literals
+        self.header = header
+        if name_order not in NAME_ORDERS:
+            raise ValueError(f"name_order must be one of {', '.join(NAME_ORDERS)}")
+        self.name_order = name_order
         
-        # Check for . or -> access
-        if parent.type == 'field_expression':
-            # node.field is the member being accessed
-            if parent.child_by_field_name('field') == node:
-                return True
+        # Initialize tree-sitter
+        self.parser = parser or get_parser()
+        self.language = self.parser.language
+        # A caller that already parsed (e.g. incrementally) passes its tree
+        self.tree = tree or self.parser.parse(self.source_bytes)
         
-        return False
-    
-    def is_static_global(self, node):
-        """Check if this is a static global variable declaration"""
-        if not self.is_declaration(node):
-            return False
+        # Function name collection
+        self.function_names = set()
+        # Public file-scope names (kept as-is, so never handed out as short names)
+        self.global_names = set()
         
-        # Walk up to find the declaration
-        p = node.parent
-        while p and p.type not in ('declaration', 'function_definition'):
-            p = p.parent
+        # Scope management
+        self.scopes = [Scope()]  # Global scope
+        self.project_names = project_names or {}
+        self.scopes[0].mappings.update(self.project_names)
+        self.short_names = None  # NameSequence for the last reserved set
         
-        if not p or p.type != 'declaration':
-            return False
+        # Identifier events recorded by walk(), replayed by resolve_identifiers()
+        self.events = []
         
-        # Check if declaration has 'static' storage class
-        for child in p.children:
-            if child.type == 'storage_class_specifier' and self.get_node_text(child) == 'static':
-                # Make sure we're at global scope (parent is translation_unit)
-                if p.parent and p.parent.type == 'translation_unit':
-                    return True
+        # Track what to keep/remove
+        self.removals = EditList()  # comments, each replaced by nothing
+        self.replacements = EditList()  # renames, appended in source order
+        self.skip = None  # (start, end) of dead subtrees, set by eliminate_dead_code()
+        self.dead_code = None  # what was dropped: deadcode.find_dead_code()'s report
+        self.folded = None  # literal rewrites, set by fold_literals()
         
-        return False
+    def get_node_text(self, node):
+        """Get the source bytes of a node"""
+        return self.source_bytes[node.start_byte:node.end_byte]
     
-    def get_scope_depth(self, node):
-        """Calculate the scope depth of a node"""
-        depth = 0
-        p = node.parent
-        while p:
-            if p.type == 'compound_statement':
-                depth += 1
-            p = p.parent
-        return depth
+    def child_context(self, frame, field):
+        """Context flags for a child of the open node described by frame"""
+        parent_type, ctx, extra = frame
+        base = ctx & CTX_INHERITED
+        
+        if parent_type in DECLARATION_TYPES:
+            if field == 'declarator':
+                return base | CTX_DECLARATOR | extra
+            return base
+        if parent_type == 'init_declarator':
+            return ctx if field == 'declarator' else base
+        if parent_type in POINTER_LIKE_DECLARATORS:
+            # int (*fp)(void): a pointer to a function is a variable
+            return ctx & ~CTX_FUNCTION_NAME if field == 'declarator' else base
+        if parent_type == 'parenthesized_declarator':
+            return ctx
+        if parent_type == 'function_declarator':
+            if field == 'declarator':
+                return ctx | CTX_FUNCTION_NAME
+            if field == 'parameters':
+                return base | extra
+            return base
+        if parent_type == 'parameter_list':
+            return base | (ctx & CTX_PARAMS_DEF)
+        if parent_type == 'parameter_declaration':
+            if field == 'declarator':
+                if ctx & CTX_PARAMS_DEF:
+                    return (base & ~CTX_FILE_SCOPE) | CTX_DECLARATOR
+                # Prototype parameter names are left alone
+                return base | CTX_PROTECTED
+            return base
+        if parent_type == 'function_definition':
+            if field == 'declarator':
+                return base | CTX_DECLARATOR | CTX_FUNCTION_DEF
+            return base & ~CTX_FILE_SCOPE
+        if parent_type in SCOPE_TYPES:
+            return base & ~CTX_FILE_SCOPE
+        if parent_type in PROTECTED_TYPES or parent_type in PREPROC_PROTECTED_TYPES:
+            return base | CTX_PROTECTED
+        if parent_type == 'field_expression':
+            return base | CTX_PROTECTED if field == 'field' else base
+        if parent_type in ('preproc_if', 'preproc_elif'):
+            return base | CTX_PROTECTED if field == 'condition' else base
+        if parent_type in ('preproc_ifdef', 'preproc_elifdef'):
+            return base | CTX_PROTECTED if field == 'name' else base
+        return base
     
-    def analyze_identifiers(self, node, in_function=False):
-        """Analyze and rename identifiers based on scope"""
-        if node.type == 'identifier':
-            name = self.get_node_text(node)
-            
-            # Skip keywords
-            if name in KEYWORDS:
-                return
-            
-            # Skip member access
-            if self.is_member_access(node):
-                return
-            
-            # Skip if in struct/union/enum definition
-            if self.is_struct_union_enum_specifier(node):
-                return
-            
-            is_decl = self.is_declaration(node)
-            
-            # Handle different cases
-            if is_decl:
-                # Static global variable
-                if self.is_static_global(node):
-                    reserved = KEYWORDS | self.function_names
-                    new_name = self.scopes[0].add_variable(name, reserved)
-                    self.replacements[node.start_byte] = (node.end_byte, new_name)
-                
-                # Local variable or parameter
-                elif in_function and self.current_scope_idx > 0:
-                    scope = self.scopes[self.current_scope_idx]
-                    if not scope.is_protected:
-                        reserved = KEYWORDS | self.function_names
-                        new_name = scope.add_variable(name, reserved)
-                        self.replacements[node.start_byte] = (node.end_byte, new_name)
-            else:
-                # Usage - look up in scopes from current to global
-                for i in range(self.current_scope_idx, -1, -1):
-                    new_name = self.scopes[i].get_mapping(name)
-                    if new_name:
-                        self.replacements[node.start_byte] = (node.end_byte, new_name)
-                        break
+    def classify_identifier(self, ctx, start, end, name):
+        """Turn an identifier into a rename event using only its context flags"""
+        if ctx & CTX_PROTECTED or name in KEYWORDS:
+            return None
         
-        # Handle scope changes
-        if node.type == 'compound_statement':
-            # Enter new scope
-            self.scopes.append(Scope())
-            self.current_scope_idx += 1
-            
-            for child in node.children:
-                self.analyze_identifiers(child, in_function=True)
-            
-            # Exit scope
-            self.scopes.pop()
-            self.current_scope_idx -= 1
+        if not ctx & CTX_DECLARATOR:
+            return (EV_USE, start, end, name)
         
-        elif node.type == 'function_definition':
-            # Function definition creates a new scope for parameters and body
-            self.scopes.append(Scope())
-            self.current_scope_idx += 1
-            
-            for child in node.children:
-                self.analyze_identifiers(child, in_function=True)
-            
-            self.scopes.pop()
-            self.current_scope_idx -= 1
+        if ctx & (CTX_FUNCTION_NAME | CTX_EXTERN):
+            if ctx & CTX_FUNCTION_NAME:
+                self.function_names.add(name)
+            else:
+                self.global_names.add(name)
+            if ctx & (CTX_FILE_SCOPE | CTX_FUNCTION_DEF):
+                # A file-scope declaration: only a project rename applies
+                return (EV_USE, start, end, name) if name in self.project_names else None
+            return (EV_DECL_KEEP, start, end, name)
         
-        elif node.type in ('struct_specifier', 'union_specifier', 'enum_specifier'):
-            # Protected scope - don't rename members
-            self.scopes.append(Scope(is_protected=True))
-            self.current_scope_idx += 1
-            
-            for child in node.children:
-                self.analyze_identifiers(child, in_function)
-            
-            self.scopes.pop()
-            self.current_scope_idx -= 1
+        if ctx & CTX_FILE_SCOPE:
+            if ctx & CTX_STATIC:
+                return (EV_DECL_STATIC, start, end, name)
+            self.global_names.add(name)
+            return (EV_USE, start, end, name) if name in self.project_names else None
         
-        else:
-            for child in node.children:
-                self.analyze_identifiers(child, in_function)
+        # Local variable or parameter
+        return (EV_DECL_LOCAL, start, end, name)
     
-    def reconstruct(self):
-        """Reconstruct the source code with removals and replacements"""
-        # Sort removals and replacements by position
-        self.removals.sort()
+    def walk(self, node=None):
+        """Single iterative pass over the AST (or the subtree rooted at node)
         
-        result = []
-        pos = 0
-        
-        # Create a list of all modifications sorted by position
-        modifications = []
-        
-        # Add removals
-        for start, end in self.removals:
-            modifications.append(('remove', start, end, None))
+        Collects comments, function names and identifier events in source
+        order. Uses a TreeCursor and an explicit stack of open nodes instead
+        of recursion, so arbitrarily deep nesting is fine. Each stack frame
+        carries context flags (inside a struct, on a declarator, static,
+        file scope, ...) that are pushed down to the children, so every
+        identifier is classified in O(1) without walking its parent chain.
+        Renaming decisions are deferred to resolve_identifiers(), which
+        replays the events once every function name is known.
         
-        # Add replacements
-        for start, (end, text) in self.replacements.items():
-            modifications.append(('replace', start, end, text))
+        A subtree root is taken to be a top-level declaration, i.e. it
+        starts out at file scope.
+        """
+        cursor = node.walk() if node is not None else self.tree.walk()
+        events = self.events
+        removals = self.removals
+        source_bytes = self.source_bytes
+        # Dead-code elimination reads the same events as renaming
+        collect_renames = self.enable_renaming or self.remove_dead_code
         
-        modifications.sort(key=lambda x: x[1])
+        # Open ancestors of the cursor: [node_type, ctx, extra flags for children]
+        stack = []
+        ctx = CTX_FILE_SCOPE
+        dropped = set()  # (start, end) of #if branches the output leaves out
         
-        # Apply modifications
-        for mod_type, start, end, text in modifications:
-            if start > pos:
-                result.append(self.source_bytes[pos:start].decode('utf-8'))
+        while True:
+            node = cursor.node
+            node_type = node.type
             
-            if mod_type == 'replace':
-                result.append(text)
-            # For 'remove', we just skip the content
+            if dropped and (node.start_byte, node.end_byte) in dropped:
+                pass  # see dropped_branches()
+            elif node_type == 'identifier':
+                if collect_renames:
+                    start, end = node.start_byte, node.end_byte
+                    name = source_bytes[start:end]
+                    event = self.classify_identifier(ctx, start, end, name)
+                    if event:
+                        events.append(event)
+                    # f(int x) { ... }: only the defined function's own
+                    # parameter list declares renameable parameters
+                    if (ctx & CTX_FUNCTION_DEF and stack
+                            and stack[-1][0] == 'function_declarator'):
+                        stack[-1][2] |= CTX_PARAMS_DEF
+            elif node_type == 'comment':
+                removals.append(node.start_byte, node.end_byte, b'')
+            elif node_type == 'preproc_params':
+                # Macro parameters belong to the macro body alone: renamed
+                # here, never resolved against the file's scopes
+                if collect_renames:
+                    events.extend(rename_macro_parameters(
+                        node, node.parent.child_by_field_name('value'), source_bytes))
+            elif (node_type == 'initializer_list' and node.end_byte - node.start_byte >= BULK_BYTES
+                    and is_literal_list(source_bytes[node.start_byte:node.end_byte])):
+                # Generated data: no identifiers, so no node needs a visit
+                for start, end in list_comments(source_bytes, node.start_byte, node.end_byte):
+                    removals.append(start, end, b'')
+            elif node_type == 'storage_class_specifier':
+                storage = self.get_node_text(node)
+                if storage == b'static':
+                    stack[-1][2] |= CTX_STATIC
+                elif storage == b'extern':
+                    stack[-1][2] |= CTX_EXTERN
+            elif cursor.goto_first_child():
+                if node_type in SCOPE_TYPES:
+                    events.append((EV_ENTER,))
+                elif node_type == 'preproc_if':
+                    dropped.update(dropped_branches(node, source_bytes))
+                frame = [node_type, ctx, 0]
+                stack.append(frame)
+                ctx = self.child_context(frame, cursor.field_name)
+                continue
             
-            pos = end
+            # Leaf (or childless node): move to the next sibling, closing any
+            # nodes we climb out of on the way
+            while not cursor.goto_next_sibling():
+                if not cursor.goto_parent():
+                    return
+                if stack.pop()[0] in SCOPE_TYPES:
+                    events.append((EV_EXIT,))
+            ctx = self.child_context(stack[-1], cursor.field_name)
+    
+    def resolve_identifiers(self, events=None, reserved=None):
+        """Replay identifier events and record renames
         
-        # Add remaining content
-        if pos < len(self.source_bytes):
-            result.append(self.source_bytes[pos:].decode('utf-8'))
+        Static globals are named in declaration order in the global scope;
+        each function body is collected and named by allocate_region().
+        """
+        if events is None:
+            events = self.events
+        if reserved is None:
+            reserved = KEYWORDS | self.function_names | self.global_names
+            reserved.update(self.project_names.values())
+        names = self.short_names
+        if names is None or names.reserved is not reserved:
+            names = self.short_names = NameSequence(reserved)
+        global_scope = self.scopes[0]
         
-        return ''.join(result)
+        depth = 0
+        region_start = 0
+        for i, event in enumerate(events):
+            kind = event[0]
+            if kind == EV_ENTER:
+                if depth == 0:
+                    region_start = i
+                depth += 1
+            elif kind == EV_EXIT:
+                depth -= 1
+                if depth == 0:
+                    self.allocate_region(events, region_start, i + 1, names)
+            elif depth == 0:
+                _, start, end, name = event
+                if kind == EV_DECL_STATIC:
+                    new_name = global_scope.add_variable(name, names)
+                    if new_name != name:
+                        self.replacements.append(start, end, new_name)
+                elif kind == EV_USE:
+                    # File-scope initializer referring to an earlier static
+                    new_name = global_scope.get_mapping(name)
+                    if new_name and new_name != name:
+                        self.replacements.append(start, end, new_name)
+                elif kind == EV_FIXED:
+                    self.replacements.append(start, end, name)
     
-    def minimize_whitespace(self, code):
-        """Minimize whitespace while preserving necessary spaces"""
-        result = []
-        i = 0
-        n = len(code)
+    def allocate_region(self, events, first, last, names):
+        """Name the locals of one function body, events[first:last]
         
-        while i < n:
-            c = code[i]
-            
-            # Handle preprocessor directives - keep them on their own line
-            if c == '#':
-                # Keep the newline before if there is one
-                if result and result[-1] != '\n':
-                    result.append('\n')
-                
-                # Copy the entire directive
-                while i < n and code[i] != '\n':
-                    result.append(code[i])
-                    i += 1
-                if i < n:
-                    result.append('\n')
-                    i += 1
+        Each binding counts its references and records which bindings it
+        interferes with: those declared after it that are still visible at
+        one of its references, since sharing its name would capture them.
+        Names that cannot change there (kept declarations, static globals,
+        unresolved identifiers) are forbidden to the bindings visible at
+        their references instead. Bindings are then named greedily, most
+        referenced first, with the shortest name no neighbour holds, so
+        disjoint scopes reuse the same short names. With name_order
+        'declaration' they are named in declaration order instead, so the
+        first parameter is always 'a' and equal shapes give equal output.
+        """
+        global_scope = self.scopes[0]
+        refs = []  # (start, end, Binding or fixed new name) in source order
+        stack = []  # visible bindings, in declaration order
+        marks = []  # stack height at each open scope
+        visible = {}  # original name -> its visible bindings, innermost last
+        fixed_checked = {}  # fixed name -> newest serial already forbidden it
+        bindings = []
+        
+        for i in range(first, last):
+            event = events[i]
+            kind = event[0]
+            if kind == EV_ENTER:
+                marks.append(len(stack))
                 continue
-            
-            # Handle strings and chars - preserve them exactly
-            if c in ('"', "'"):
-                quote = c
-                result.append(c)
-                i += 1
-                while i < n:
-                    if code[i] == '\\':
-                        result.append(code[i])
-                        i += 1
-                        if i < n:
-                            result.append(code[i])
-                            i += 1
-                    elif code[i] == quote:
-                        result.append(code[i])
-                        i += 1
-                        break
-                    else:
-                        result.append(code[i])
-                        i += 1
+            if kind == EV_EXIT:
+                mark = marks.pop()
+                for binding in stack[mark:]:
+                    visible[binding.name].pop()
+                del stack[mark:]
                 continue
             
-            # Handle whitespace
-            if c.isspace():
-                # Skip all consecutive whitespace
-                while i < n and code[i].isspace():
-                    i += 1
-                
-                # Determine if we need a space
-                if result:
-                    prev = result[-1]
-                    if i < n:
-                        next_c = code[i]
-                        
-                        # Need space between alphanumeric/underscore characters
-                        if (prev.isalnum() or prev == '_') and (next_c.isalnum() or next_c == '_'):
-                            result.append(' ')
-                        # Avoid ++ or -- ambiguity
-                        elif prev == '+' and next_c == '+':
-                            result.append(' ')
-                        elif prev == '-' and next_c == '-':
-                            result.append(' ')
+            _, start, end, name = event
+            if kind == EV_FIXED:
+                refs.append((start, end, name))
                 continue
+            if kind == EV_USE:
+                chain = visible.get(name)
+                if not chain:
+                    # A static global or a name from outside this file
+                    fixed = global_scope.get_mapping(name) or name
+                    if fixed != name:
+                        refs.append((start, end, fixed))
+                    checked = fixed_checked.get(fixed, -1)
+                    for other in reversed(stack):
+                        if other.serial <= checked:
+                            break
+                        if other.new_name is None:
+                            other.forbidden.add(fixed)
+                    if stack:
+                        fixed_checked[fixed] = stack[-1].serial
+                    continue
+                binding = chain[-1]
+            elif (visible.get(name) and len(stack) > marks[-1]
+                    and visible[name][-1].serial >= stack[marks[-1]].serial):
+                # Declared again in the same scope, as the arms of an
+                # #ifdef/#else do: one object, so one name
+                binding = visible[name][-1]
+            else:
+                if kind == EV_DECL_KEEP:
+                    # Names the file-scope object, which may be renamed there
+                    fixed = global_scope.get_mapping(name) or name
+                else:
+                    fixed = name if name in names.reserved else None
+                binding = Binding(name, len(bindings), fixed)
+                bindings.append(binding)
+                visible.setdefault(name, []).append(binding)
+                # Declarations of one scope never share a name, even when
+                # neither is referenced again. Each declaration links the
+                # scope's older bindings, so they stay linked up to it
+                for other in stack[marks[-1]:]:
+                    other.interfere(binding)
+                    other.checked = binding.serial
+                stack.append(binding)
+            binding.uses += 1
+            refs.append((start, end, binding))
             
-            result.append(c)
-            i += 1
+            # Bindings declared since this one was last referenced; any
+            # older one still visible was already linked then
+            for other in reversed(stack):
+                if other.serial <= binding.checked:
+                    break
+                binding.interfere(other)
+            binding.checked = stack[-1].serial
         
-        return ''.join(result)
-    
-    def minify(self):
-        """Main minification process"""
-        # Step 0: Collect all function names to avoid naming conflicts
-        self.collect_function_names(self.tree.root_node)
+        renamed = [binding for binding in bindings if binding.new_name is None]
+        if self.name_order == 'uses':
+            renamed.sort(key=lambda binding: (-binding.uses, binding.serial))
+        for binding in renamed:
+            taken = binding.forbidden
+            taken.update(other.new_name for other in binding.neighbors
+                         if other.new_name is not None)
+            index = 0
+            new_name = names[0]
+            while new_name in taken:
+                index += 1
+                new_name = names[index]
+            binding.new_name = new_name
         
-        # Step 1: Remove comments
-        self.find_comments(self.tree.root_node)
+        # Back in source order, so the edit list needs no sort
+        replacements = self.replacements
+        for start, end, owner in refs:
+            if owner.__class__ is Binding:
+                if owner.new_name == owner.name:
+                    continue
+                owner = owner.new_name
+            replacements.append(start, end, owner)
+    
+    def eliminate_dead_code(self):
+        """Mark dead definitions for emit() and drop their events
         
-        # Step 2: Rename variables if enabled
-        if ENABLE_RENAMING:
-            self.analyze_identifiers(self.tree.root_node)
+        Runs between walk() and resolve_identifiers(), so dead statics and
+        locals take no short names from the live ones.
+        """
+        import deadcode
+        self.skip, self.dead_code = deadcode.find_dead_code(self)
+        if self.skip:
+            self.events = deadcode.live_events(self.events, self.skip)
+    
+    def fold_literals(self):
+        """Collect the shorter spellings of literals and constant expressions"""
+        import literals
+        self.folded = literals.compact_literals(self)
+    
+    def emit(self, sink=None):
+        """Write the tokens of the whole tree, renamed and compacted
         
-        # Step 3: Reconstruct code
-        code = self.reconstruct()
+        Returns the output, or with a sink streams it there and returns
+        the number of bytes written.
+        """
+        emitter = TokenEmitter(self.source_bytes, self.replacements, sink, skip=self.skip,
+                               folded=self.folded)
+        emitter.emit(self.tree.root_node)
+        if sink is None:
+            return emitter.getvalue()
+        emitter.flush()
+        return emitter.written
+    
+    def prepare(self):
+        """Every pass before emit(): walk, then the optional ones and renaming"""
+        # One pass over the AST for comments, function names and
+        # identifier events
+        self.walk()
+        if self.remove_dead_code:
+            self.eliminate_dead_code()
+        if self.enable_renaming:
+            self.resolve_identifiers()
+        if self.compact_literals:
+            self.fold_literals()
+    
+    def minify(self):
+        """Main minification process; returns the minified source as bytes"""
+        self.prepare()
+        # Emit the AST's tokens with renames applied and only the
+        # separators that keep them apart
+        return self.emit()
+    
+    def minify_to(self, sink):
+        """Like minify(), but stream the output to a file, writer or callable
         
-        # Step 4: Minimize whitespace
-        code = self.minimize_whitespace(code)
+        Returns the number of bytes written.
+        """
+        self.prepare()
+        return self.emit(sink)
+
+
+class MinifierSession:
+    """Embedding entry point: options per call, bytes in, bytes out
+    
+    A session holds only its default options, so one instance may be shared
+    by any number of threads. Each call parses with the calling thread's
+    own parser and passes the source as one contiguous buffer, which
+    tree-sitter parses without holding the GIL; a thread pool therefore
+    overlaps parsing with I/O and other threads' Python work.
+    """
+    def __init__(self, enable_renaming=None, remove_dead_code=False, compact_literals=False,
+                 name_order='uses'):
+        # None: follow the module-level ENABLE_RENAMING at call time
+        self.enable_renaming = enable_renaming
+        # Defaults for the optional passes, each overridable per call
+        self.passes = {'remove_dead_code': remove_dead_code,
+                       'compact_literals': compact_literals, 'name_order': name_order}
+    
+    def options(self, enable_renaming):
+        """Effective renaming setting for one call"""
+        if enable_renaming is not None:
+            return enable_renaming
+        if self.enable_renaming is not None:
+            return self.enable_renaming
+        return ENABLE_RENAMING
+    
+    def pass_options(self, overrides):
+        """Effective CMinifier pass options for one call; None keeps the session's"""
+        unknown = overrides.keys() - self.passes.keys()
+        if unknown:
+            raise TypeError(f"Unknown option: {', '.join(sorted(unknown))}")
+        return {name: default if overrides.get(name) is None else overrides[name]
+                for name, default in self.passes.items()}
+    
+    def minifier(self, source, enable_renaming=None, **passes):
+        """A CMinifier for source, parsed on this thread's parser
         
-        return code
+        passes are remove_dead_code, compact_literals and name_order, as
+        for CMinifier; those left out (or None) take the session's defaults.
+        """
+        if isinstance(source, str):
+            source = source.encode('utf-8')
+        elif not isinstance(source, (bytes, mmap.mmap)):
+            # bytearray/memoryview: a private copy, so the caller may reuse it
+            source = bytes(source)
+        return CMinifier(source, get_parser(), enable_renaming=self.options(enable_renaming),
+                         **self.pass_options(passes))
+    
+    def minify(self, source, enable_renaming=None, **passes):
+        """Minified bytes of source (bytes-like; str is encoded as UTF-8)"""
+        return self.minifier(source, enable_renaming, **passes).minify()
+    
+    def minify_to(self, source, sink, enable_renaming=None, **passes):
+        """Stream the minified source to sink; returns the number of bytes written"""
+        return self.minifier(source, enable_renaming, **passes).minify_to(sink)
+    
+    def minify_file(self, path, enable_renaming=None, **passes):
+        """Minified bytes of a file, read through read_source()"""
+        return self.minify(read_source(path), enable_renaming, **passes)
 
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: python3 minify.py <file.c>")
+        print("Usage: python3 minify.py <file.c> [--stats[=report.json]] [--remove-dead-code]"
+              " [--compact-literals] [--verify] [--jobs=N]")
+        print("       python3 minify.py -o <out_dir> [-j N] [--stats [FILE]] [--verify]"
+              " [--remove-dead-code] [--compact-literals] [--name-order ORDER]"
+              " <dir|glob|@manifest|file.c>...")
         sys.exit(1)
     
-    with open(sys.argv[1], 'r') as f:
-        source = f.read()
+    args = sys.argv[1:]
+    stats_path = None
+    remove_dead_code = compact_literals = verify_output = False
+    jobs = None
+    options = args[1:]
+    if options and all(option.partition('=')[0] == '--stats' or option.startswith('--jobs=')
+                       or option in PASS_OPTIONS for option in options):
+        for option in options:
+            if option.startswith('--jobs='):
+                # Split one large file across processes (see parallel.py)
+                jobs = int(option.partition('=')[2])
+            elif option == '--remove-dead-code':
+                remove_dead_code = True
+            elif option == '--compact-literals':
+                compact_literals = True
+            elif option == '--verify':
+                verify_output = True
+            else:
+                # Per-phase report to stderr, or to the file given after '='
+                stats_path = option.partition('=')[2] or '-'
+        args = args[:1]
+    
+    if len(args) > 1 or args[0].startswith('-'):
+        # Batch mode: many inputs mirrored into an output directory
+        import batch
+        sys.exit(batch.main(args))
+    
+    if jobs is not None:
+        if stats_path or remove_dead_code or compact_literals or verify_output:
+            print("Error: --jobs takes no other options", file=sys.stderr)
+            sys.exit(1)
+        import parallel
+        sys.exit(parallel.main([args[0], f'--jobs={jobs}']))
+    
+    if stats_path:
+        import stats
+        _, report = stats.profile(read_source(args[0]), sink=sys.stdout.buffer, name=args[0],
+                                  remove_dead_code=remove_dead_code,
+                                  compact_literals=compact_literals, verify=verify_output,
+                                  header=args[0].endswith(HEADER_EXTENSIONS))
+        sys.stdout.buffer.write(b'\n')
+        sys.stdout.flush()
+        stats.write_report(report, stats_path)
+        if report.get('divergence'):
+            import verify
+            print(verify.format_divergence(args[0], report['divergence']), file=sys.stderr)
+            sys.exit(1)
+        return
     
-    minifier = CMinifier(source)
-    minified = minifier.minify()
-    print(minified)
+    minifier = CMinifier(read_source(args[0]), remove_dead_code=remove_dead_code,
+                         compact_literals=compact_literals,
+                         header=args[0].endswith(HEADER_EXTENSIONS))
+    if verify_output:
+        # Checked once written: a divergence still leaves the output to inspect
+        output = minifier.minify()
+        sys.stdout.buffer.write(output)
+    else:
+        minifier.minify_to(sys.stdout.buffer)
+    sys.stdout.buffer.write(b'\n')
+    if remove_dead_code:
+        import deadcode
+        sys.stdout.flush()
+        print(deadcode.format_report(minifier.dead_code), file=sys.stderr)
+    if verify_output:
+        import verify
+        divergence = verify.verify(minifier, output)
+        if divergence is not None:
+            sys.stdout.flush()
+            print(verify.format_divergence(args[0], divergence), file=sys.stderr)
+            sys.exit(1)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""
+Intra-file parallelism for huge translation units
+
+Splits one file into chunks at lines that close a top-level brace and
+minifies them on a process pool in two rounds:
+1. Parse and emit: each worker parses its chunk once, emits it with every
+   renamable identifier as written, and reports where those identifiers
+   landed in the output, the identifier events and the file-scope names
+   (functions, public globals) and static globals the chunk declares
+2. Rename: with the reserved names and the static-global scope at the start
+   of its chunk, each worker replays the chunk's events (no parsing)
+The parent patches the new names into the chunk outputs and stitches them
+together in order with the same seam rules as the incremental session, so
+the result is byte-identical to CMinifier(source).minify(). Chunks end
+only outside preprocessor conditionals; if there is no such line, or a
+chunk still does not parse cleanly on its own, the file falls back to the
+sequential path and the report says why.
+
+Usage: python3 parallel.py [-j N] <file.c>
+"""
+
+import argparse
+import os
+import re
+import sys
+from concurrent.futures import ProcessPoolExecutor
+from itertools import accumulate
+
+import minify
+from incremental import join_segments
+
+# Chunks per worker, so uneven declarations still balance
+CHUNKS_PER_JOB = 4
+# Files smaller than this are not worth the pool start-up
+MIN_PARALLEL_BYTES = 256 * 1024
+# End of a line holding only the '}' (or '};') that closes a top-level
+# definition: where a chunk may end without parsing the whole file
+CHUNK_END = rb'^\}[^\S\n]*;?[^\S\n]*\n'
+# A directive opening or closing a conditional; a chunk may only end
+# outside all of them
+CONDITIONAL = rb'^[ \t]*#[ \t]*(if|ifdef|ifndef|endif)\b'
+BOUNDARY = re.compile(CHUNK_END + b'|' + CONDITIONAL, re.M)
+# Events naming an identifier that resolve_identifiers() may rename
+RENAMABLE_EVENTS = (minify.EV_DECL_STATIC, minify.EV_DECL_LOCAL, minify.EV_USE)
+
+
+class SlotEmitter(minify.TokenEmitter):
+    """A TokenEmitter that notes which output tokens are renamable identifiers"""
+    def __init__(self, source_bytes, edits, renamable):
+        super().__init__(source_bytes, edits)
+        self.renamable = renamable  # source starts of identifiers a rename may replace
+        self.slots = []  # (index in out, source start) of each one written
+
+    def leaf(self, node, text=None, node_type=None):
+        out = self.out
+        written = len(out)
+        super().leaf(node, text, node_type)
+        if len(out) > written and node.start_byte in self.renamable:
+            self.slots.append((len(out) - 1, node.start_byte))
+
+
+class ChunkOutput:
+    """A chunk's output and the emitter state at its ends, for join_segments()
+
+    Until rename() fills in the new names, slots lists (output offset,
+    length, source start) of every renamable identifier, and events, names
+    and statics hold what round 2 and the parent need from the walk.
+    """
+    __slots__ = ('output', 'head', 'head_directive', 'tail', 'tail_number', 'newline_pending',
+                 'slots', 'events', 'names', 'statics')
+
+    def __init__(self, emitter, minifier=None):
+        out = emitter.out
+        self.output = b''.join(out)
+        self.head, self.head_directive = emitter.head or (b'', False)
+        self.tail = emitter.prev
+        self.tail_number = emitter.prev_number
+        self.newline_pending = emitter.newline_pending
+        self.slots = []
+        self.events = None
+        self.names = frozenset()
+        self.statics = []
+        if minifier is not None:
+            lengths = [len(token) for token in out]
+            offsets = [0, *accumulate(lengths)]
+            self.slots = [(offsets[i], lengths[i], start) for i, start in emitter.slots]
+            self.events = minifier.events
+            self.names = minifier.function_names | minifier.global_names
+            self.statics = [event[3] for event in minifier.events
+                            if event[0] == minify.EV_DECL_STATIC]
+
+    def rename(self, renames):
+        """Write the new names (source start -> name) over their slots
+
+        A name is a word like the one it replaces, so the separators stay
+        right, except around a string or char literal: 'L "x"' keeps its
+        space, 'a"x"' needs none.
+        """
+        output = self.output
+        pieces = []
+        pos = 0
+        for offset, length, start in self.slots:
+            name = renames.get(start)
+            if name is None:
+                continue
+            old = output[offset:offset + length]
+            after = offset + length
+            if (old in minify.STRING_PREFIXES) != (name in minify.STRING_PREFIXES):
+                following = output[after:after + 2]
+                if old in minify.STRING_PREFIXES:
+                    if following[:1] == b' ' and following[1:2] in (b'"', b"'"):
+                        after += 1
+                elif following[:1] in (b'"', b"'"):
+                    name += b' '
+            pieces.append(output[pos:offset])
+            pieces.append(name)
+            if offset == 0:
+                self.head = name.rstrip(b' ')
+            if after == len(output):
+                self.tail = name
+            pos = after
+        pieces.append(output[pos:])
+        self.output = b''.join(pieces)
+        self.slots = self.events = None
+
+
+def split_chunks(source_bytes, count):
+    """Byte ranges of about count chunks, each ending after a line that closes a brace
+
+    Found on the text alone, so the parent never parses the whole file.
+    A line inside an #if/#ifdef/#ifndef block is never a boundary, since
+    neither half of a split conditional parses; a split in the middle of
+    another construct (a comment, say) leaves a chunk that does not parse
+    cleanly, which sends the file down the sequential path.
+    """
+    target = len(source_bytes) / count
+    chunks = []
+    start = 0
+    depth = 0
+    for match in BOUNDARY.finditer(source_bytes):
+        conditional = match.group(1)
+        if conditional is not None:
+            # A stray #endif leaves depth negative: no more cuts, rather than wrong ones
+            depth += -1 if conditional == b'endif' else 1
+            continue
+        end = match.end()
+        if depth == 0 and end - start >= target and end < len(source_bytes):
+            chunks.append((start, end))
+            start = end
+    chunks.append((start, len(source_bytes)))
+    return chunks
+
+
+def emit_chunk(task):
+    """Round 1: parse a chunk once, walk and emit it; None if it has parse errors"""
+    text, enable_renaming = task
+    tree = minify.get_parser().parse(text)
+    if tree.root_node.has_error:
+        return None
+    if not enable_renaming:
+        emitter = minify.TokenEmitter(text, minify.EditList())
+        emitter.emit(tree.root_node)
+        emitter.finish()
+        return ChunkOutput(emitter)
+    minifier = minify.CMinifier(text, enable_renaming=True, tree=tree)
+    minifier.walk()
+    # Macro bodies and parameters are rewritten the same whatever the
+    # rest of the file holds: apply them now, leave the renames for later
+    fixed = minify.EditList()
+    renamable = set()
+    for event in minifier.events:
+        kind = event[0]
+        if kind == minify.EV_FIXED:
+            fixed.append(event[1], event[2], event[3])
+        elif kind in RENAMABLE_EVENTS:
+            renamable.add(event[1])
+    emitter = SlotEmitter(text, fixed, renamable)
+    emitter.emit(tree.root_node)
+    emitter.finish()
+    return ChunkOutput(emitter, minifier)
+
+
+def rename_chunk(task):
+    """Round 2: renames of a chunk against the file-scope state at its start"""
+    events, reserved, global_scope = task
+    minifier = minify.CMinifier(b'', enable_renaming=True)
+    minifier.scopes = [global_scope]
+    minifier.resolve_identifiers(events, reserved)
+    return {start: name for start, _, name in minifier.replacements}
+
+
+def init_worker():
+    """Pool initializer: build this worker's Language/Parser once"""
+    minify.get_parser()
+
+
+def minify_sequential(source, enable_renaming):
+    """The single-process path, for small files and chunks that do not split cleanly"""
+    return minify.CMinifier(source, enable_renaming=enable_renaming).minify()
+
+
+def minify_parallel(source, jobs=None, enable_renaming=None, pool=None, report=None):
+    """CMinifier(source).minify(), with the work split across processes
+
+    pool may be a ProcessPoolExecutor to reuse across files; otherwise one
+    with jobs workers (default: all cores) is created for this call.
+    report, if a dict, receives the number of chunks and, when a file
+    large enough to split went down the sequential path, the reason.
+    """
+    if report is not None:
+        report.update({'chunks': 1, 'fallback': None})
+    if isinstance(source, str):
+        source = source.encode('utf-8')
+    if enable_renaming is None:
+        enable_renaming = minify.ENABLE_RENAMING
+    if jobs is None:
+        jobs = os.cpu_count() or 1
+    if jobs <= 1 or len(source) < MIN_PARALLEL_BYTES:
+        return minify_sequential(source, enable_renaming)
+
+    chunks = split_chunks(source, jobs * CHUNKS_PER_JOB)
+    if len(chunks) == 1:
+        if report is not None:
+            report['fallback'] = "no top-level '}' line outside a preprocessor conditional"
+        return minify_sequential(source, enable_renaming)
+    if report is not None:
+        report['chunks'] = len(chunks)
+
+    own_pool = pool is None
+    if own_pool:
+        pool = ProcessPoolExecutor(max_workers=jobs, initializer=init_worker)
+    try:
+        outputs = list(pool.map(emit_chunk, [(source[start:end], enable_renaming)
+                                             for start, end in chunks]))
+        if None in outputs:
+            if report is not None:
+                start, end = chunks[outputs.index(None)]
+                report['fallback'] = f"bytes {start}-{end} do not parse on their own"
+            return minify_sequential(source, enable_renaming)
+
+        if enable_renaming:
+            reserved = minify.KEYWORDS.union(*(output.names for output in outputs))
+            # Static globals each chunk starts with: replay the earlier chunks' ones
+            global_scope = minify.Scope()
+            names = minify.NameSequence(reserved)
+            tasks = []
+            for output in outputs:
+                snapshot = minify.Scope()
+                snapshot.mappings = dict(global_scope.mappings)
+                snapshot.counter = global_scope.counter
+                tasks.append((output.events, reserved, snapshot))
+                for name in output.statics:
+                    global_scope.add_variable(name, names)
+            for output, renames in zip(outputs, pool.map(rename_chunk, tasks)):
+                output.rename(renames)
+    finally:
+        if own_pool:
+            pool.shutdown()
+
+    return join_segments(outputs)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Minify one large C file on several cores')
+    parser.add_argument('file')
+    parser.add_argument('-j', '--jobs', type=int, default=None,
+                        help='worker processes (default: all cores)')
+    parser.add_argument('--no-rename', action='store_true', help='disable variable renaming')
+    args = parser.parse_args(argv)
+
+    report = {}
+    output = minify_parallel(minify.read_source(args.file), args.jobs,
+                             enable_renaming=False if args.no_rename else None, report=report)
+    if report['fallback']:
+        print(f"Minified sequentially: {report['fallback']}", file=sys.stderr)
+    sys.stdout.buffer.write(output + b'\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
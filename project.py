@@ -0,0 +1,369 @@
+#!/usr/bin/env python3
+"""
+Project mode: rename external symbols consistently across many files
+
+Single-file minification must keep every function and public global at
+full length, since other files may refer to them. Project mode sees all
+the files at once:
+1. Index: every source is scanned for the non-static functions and
+   variables it defines, the words it uses (with counts) and the words
+   that appear in its preprocessor directives. The index is stored on
+   disk; a file whose size and mtime (or, failing that, content hash)
+   are unchanged is not reparsed on later runs.
+2. Map: a symbol defined in the project gets a short name unless it is
+   'main', listed in the public API file, or named in any directive
+   (macro bodies are emitted verbatim, so they cannot follow a rename).
+   The most referenced symbols get the shortest names, and no short name
+   is a word used anywhere in the project.
+3. Minify: every file is minified with the map applied to declarations
+   and uses alike, and mirrored into the output directory. The index
+   keeps a hash of the part of the map each file's words touch and of the
+   output written; a file whose content, map hash and output are all
+   unchanged is neither minified nor parsed again.
+
+Usage: python3 project.py -o <out_dir> [--index FILE] [--api FILE] [--map FILE] [-j N]
+                         <dir|glob|@manifest|file>...
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import sys
+import time
+from collections import Counter
+from concurrent.futures import ProcessPoolExecutor
+
+import minify
+from batch import expand_inputs, init_worker
+
+INDEX_FORMAT = 'cminify-project-index'
+DEFAULT_INDEX = '.cminify-index.json'
+
+# Identifier-like words; over-approximates (comments, strings) on purpose
+WORD = re.compile(rb'[A-Za-z_][A-Za-z0-9_]*')
+# A directive line with its backslash continuations
+DIRECTIVE = re.compile(rb'^[ \t]*#(?:[^\n]*\\\r?\n)*[^\n]*', re.M)
+# Top-level nodes whose children are top-level declarations too
+CONTAINER_TYPES = {'preproc_if', 'preproc_ifdef', 'preproc_else', 'preproc_elif',
+                   'preproc_elifdef', 'linkage_specification', 'declaration_list'}
+
+
+def storage_classes(node, source_bytes):
+    """Storage-class keywords of a declaration or function definition"""
+    return {bytes(source_bytes[child.start_byte:child.end_byte])
+            for child in node.children if child.type == 'storage_class_specifier'}
+
+
+def declarator_name(declarator, source_bytes):
+    """(name, declares a function) for a declarator chain, or (None, False)"""
+    is_function = False
+    while declarator is not None and declarator.type != 'identifier':
+        if declarator.type == 'function_declarator':
+            is_function = True
+        inner = declarator.child_by_field_name('declarator')
+        if inner is None:
+            # parenthesized_declarator has no field name for its child
+            inner = next((child for child in declarator.named_children), None)
+        declarator = inner
+    if declarator is None:
+        return None, False
+    return bytes(source_bytes[declarator.start_byte:declarator.end_byte]), is_function
+
+
+def definitions(node, source_bytes):
+    """Names of the non-static functions and variables defined at file scope"""
+    for child in node.children:
+        if child.type in CONTAINER_TYPES:
+            yield from definitions(child, source_bytes)
+        elif child.type == 'function_definition':
+            if b'static' not in storage_classes(child, source_bytes):
+                name, _ = declarator_name(child.child_by_field_name('declarator'), source_bytes)
+                if name:
+                    yield name
+        elif child.type == 'declaration':
+            if storage_classes(child, source_bytes) & {b'static', b'extern'}:
+                continue
+            for declarator in child.children_by_field_name('declarator'):
+                name, is_function = declarator_name(declarator, source_bytes)
+                if name and not is_function:  # a prototype defines nothing
+                    yield name
+
+
+def scan_file(path):
+    """Index record of one source file"""
+    with open(path, 'rb') as f:
+        source = f.read()
+    st = os.stat(path)
+    tree = minify.get_parser().parse(source)
+    directive_words = set()
+    for match in DIRECTIVE.finditer(source):
+        directive_words.update(WORD.findall(match.group()))
+    return {
+        'size': st.st_size,
+        'mtime_ns': st.st_mtime_ns,
+        'sha256': hashlib.sha256(source).hexdigest(),
+        # Identifiers matched by WORD are ASCII, so decoding cannot fail;
+        # a definition with other bytes in its name is simply never renamed
+        'defines': sorted({name.decode('ascii') for name in definitions(tree.root_node, source)
+                           if name.isascii()}),
+        'words': {word.decode('ascii'): count
+                  for word, count in Counter(WORD.findall(source)).items()},
+        'directive_words': sorted(word.decode('ascii') for word in directive_words),
+    }
+
+
+class ProjectIndex:
+    """Per-file index records, persisted as JSON between runs"""
+    def __init__(self, path=None):
+        self.path = path
+        self.files = {}  # absolute path -> record from scan_file()
+        self.reparsed = 0  # files scanned by the last update()
+        if path and os.path.exists(path):
+            try:
+                with open(path, 'r') as f:
+                    data = json.load(f)
+            except (OSError, ValueError):
+                data = None
+            # Another minifier version may have indexed differently
+            if (isinstance(data, dict) and data.get('format') == INDEX_FORMAT
+                    and data.get('version') == minify.MINIFIER_VERSION):
+                self.files = data['files']
+
+    def is_current(self, path, record):
+        """True if record still describes the file at path"""
+        st = os.stat(path)
+        if record['size'] != st.st_size:
+            return False
+        if record['mtime_ns'] == st.st_mtime_ns:
+            return True
+        # Touched but maybe unchanged: hashing is far cheaper than parsing
+        with open(path, 'rb') as f:
+            if hashlib.sha256(f.read()).hexdigest() != record['sha256']:
+                return False
+        record['mtime_ns'] = st.st_mtime_ns
+        return True
+
+    def update(self, paths, pool=None):
+        """Bring the index in line with paths, rescanning only changed files"""
+        keys = [os.path.abspath(path) for path in paths]
+        stale = [key for key in keys
+                 if key not in self.files or not self.is_current(key, self.files[key])]
+        records = pool.map(scan_file, stale) if pool else map(scan_file, stale)
+        for key, record in zip(stale, records):
+            self.files[key] = record
+        self.files = {key: self.files[key] for key in keys}
+        self.reparsed = len(stale)
+
+    def map_digest(self, path, mapping):
+        """Hash of the renames that apply to the words of one indexed file"""
+        digest = hashlib.sha256()
+        for word in sorted(self.files[os.path.abspath(path)]['words']):
+            short = mapping.get(word.encode('ascii'))
+            if short is not None:
+                digest.update(b'%s=%s\n' % (word.encode('ascii'), short))
+        return digest.hexdigest()
+
+    def reusable_output(self, path, output_path, map_digest):
+        """Size of the output last written for path if it is still valid, else None
+
+        Valid means written to the same place with the same renames, from
+        the content indexed now, and not modified since.
+        """
+        record = self.files[os.path.abspath(path)]
+        if (record.get('map_sha256') != map_digest or record.get('output') != output_path
+                or not os.path.isfile(output_path)):
+            return None
+        with open(output_path, 'rb') as f:
+            if hashlib.sha256(f.read()).hexdigest() != record['output_sha256']:
+                return None
+        return record['output_bytes']
+
+    def record_output(self, path, output_path, map_digest, output_bytes, output_digest):
+        """Remember what was written for path, for reusable_output() on later runs"""
+        record = self.files[os.path.abspath(path)]
+        record['map_sha256'] = map_digest
+        record['output'] = output_path
+        record['output_bytes'] = output_bytes
+        record['output_sha256'] = output_digest
+
+    def save(self):
+        if not self.path:
+            return
+        data = {'format': INDEX_FORMAT, 'version': minify.MINIFIER_VERSION, 'files': self.files}
+        tmp_path = self.path + '.tmp'
+        with open(tmp_path, 'w') as f:
+            json.dump(data, f)
+        os.replace(tmp_path, self.path)
+
+    def symbol_map(self, public=()):
+        """Short names for the symbols provably internal to the project
+
+        Returns {original: short} as bytes.
+        """
+        defined = set()
+        directive_words = set()
+        counts = Counter()
+        for record in self.files.values():
+            defined.update(record['defines'])
+            directive_words.update(record['directive_words'])
+            counts.update(record['words'])
+        internal = defined - directive_words - set(public) - {'main'}
+
+        # Never reuse a word of the project: whatever keeps its spelling
+        # (libc names, typedefs, members, kept locals) stays unambiguous
+        reserved = minify.KEYWORDS | {word.encode('ascii') for word in counts}
+        names = minify.NameSequence(reserved)
+        mapping = {}
+        for name in sorted(internal, key=lambda name: (-counts[name], name)):
+            short = names[len(mapping)]
+            if len(short) >= len(name):
+                continue  # already as short as it gets
+            mapping[name.encode('ascii')] = short
+        return mapping
+
+
+# The project's symbol map in each worker, set up by init_project_worker()
+_project_names = None
+
+
+def init_project_worker(project_names):
+    """Pool initializer: this worker's parser plus the project's symbol map"""
+    global _project_names
+    init_worker()
+    _project_names = project_names
+
+
+def minify_file(task):
+    """Minify one file of the project and write its output; runs inside a worker
+
+    Returns (source_path, input_bytes, output_bytes, seconds, error,
+    SHA-256 of the file written).
+    """
+    source_path, output_path = task
+    start = time.perf_counter()
+    try:
+        source = minify.read_source(source_path)
+        minifier = minify.CMinifier(source, enable_renaming=True, project_names=_project_names)
+        os.makedirs(os.path.dirname(output_path) or '.', exist_ok=True)
+        digest = hashlib.sha256()
+        with open(output_path, 'wb') as f:
+            def write(chunk):
+                digest.update(chunk)
+                f.write(chunk)
+            out_bytes = minifier.minify_to(write)
+            write(b'\n')
+    except Exception as e:
+        return source_path, 0, 0, time.perf_counter() - start, f"{type(e).__name__}: {e}", None
+    return source_path, len(source), out_bytes, time.perf_counter() - start, None, digest.hexdigest()
+
+
+def read_public_api(path):
+    """Symbol names from an API file: one per line, '#' starts a comment"""
+    names = set()
+    with open(path, 'r') as f:
+        for line in f:
+            names.update(line.split('#', 1)[0].split())
+    return names
+
+
+def run_project(inputs, output_dir, index_path=DEFAULT_INDEX, public=(), jobs=None):
+    """Index, map and minify a project; returns (index, symbol map, results)
+
+    Each result is (source_path, input_bytes, output_bytes, seconds, error,
+    reused), reused being True for an output kept from an earlier run.
+    """
+    files = expand_inputs(inputs)
+    tasks = [(source, os.path.join(output_dir, rel)) for source, rel in files]
+    if jobs is None:
+        jobs = os.cpu_count() or 1
+    jobs = max(1, min(jobs, len(tasks)))
+
+    index = ProjectIndex(index_path)
+    if jobs == 1:
+        index.update([source for source, _ in files])
+    else:
+        with ProcessPoolExecutor(max_workers=jobs, initializer=init_worker) as pool:
+            index.update([source for source, _ in files], pool)
+    mapping = index.symbol_map(public)
+
+    by_source = {}
+    digests = {}
+    pending = []
+    for source, output_path in tasks:
+        digests[source] = index.map_digest(source, mapping)
+        output_bytes = index.reusable_output(source, output_path, digests[source])
+        if output_bytes is None:
+            pending.append((source, output_path))
+        else:
+            size = index.files[os.path.abspath(source)]['size']
+            by_source[source] = (source, size, output_bytes, 0.0, None, True)
+
+    if jobs == 1 or len(pending) < 2:
+        init_project_worker(mapping)
+        results = [minify_file(task) for task in pending]
+    else:
+        with ProcessPoolExecutor(max_workers=min(jobs, len(pending)),
+                                 initializer=init_project_worker,
+                                 initargs=(mapping,)) as pool:
+            results = list(pool.map(minify_file, pending, chunksize=1))
+    for (source, output_path), result in zip(pending, results):
+        source, in_bytes, out_bytes, seconds, error, output_digest = result
+        if error is None:
+            index.record_output(source, output_path, digests[source], out_bytes, output_digest)
+        by_source[source] = (source, in_bytes, out_bytes, seconds, error, False)
+    index.save()
+    return index, mapping, [by_source[source] for source, _ in tasks]
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description='Minify a whole C project, renaming its internal external symbols')
+    parser.add_argument('inputs', nargs='+',
+                        help='source files, directories, globs or @manifest files')
+    parser.add_argument('-o', '--output-dir', required=True,
+                        help='directory that mirrors the minified inputs')
+    parser.add_argument('--index', default=DEFAULT_INDEX,
+                        help=f'symbol index file, reused between runs (default: {DEFAULT_INDEX})')
+    parser.add_argument('--api', default=None,
+                        help='file listing public symbols that keep their names')
+    parser.add_argument('--map', default=None,
+                        help='write the applied symbol map here as JSON')
+    parser.add_argument('-j', '--jobs', type=int, default=None,
+                        help='worker processes (default: all cores)')
+    args = parser.parse_args(argv)
+
+    try:
+        public = read_public_api(args.api) if args.api else ()
+        index, mapping, results = run_project(args.inputs, args.output_dir, args.index,
+                                              public, args.jobs)
+    except (FileNotFoundError, OSError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    if args.map:
+        with open(args.map, 'w') as f:
+            json.dump({name.decode('ascii'): short.decode('ascii')
+                       for name, short in mapping.items()}, f, indent=2, sort_keys=True)
+
+    failed = 0
+    reused = 0
+    total_in = total_out = 0
+    for source, in_bytes, out_bytes, _, error, kept in results:
+        if error:
+            failed += 1
+            print(f"FAILED {source}: {error}", file=sys.stderr)
+        else:
+            total_in += in_bytes
+            total_out += out_bytes
+            reused += kept
+    print(f"Indexed {len(index.files)} files ({index.reparsed} reparsed), "
+          f"renamed {len(mapping)} external symbols", file=sys.stderr)
+    print(f"Minified {len(results) - failed}/{len(results)} files ({reused} unchanged): "
+          f"{total_in} -> {total_out} bytes", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -9,6 +9,16 @@ import os
 import subprocess
 import time
 
+# The default streamed run, then every combination of the optional passes
+# with --verify checking each output against its source
+OPTION_SETS = [
+    "",
+    "--verify",
+    "--verify --remove-dead-code",
+    "--verify --compact-literals",
+    "--verify --remove-dead-code --compact-literals",
+]
+
 
 def run_cmd(cmd, silent=False):
     """Run a shell command and return the result"""
@@ -22,20 +32,21 @@ def main():
     test_dir = "./tests"
     files = sorted([f for f in os.listdir(test_dir) if f.endswith(".c")])
     
-    print(f"Found {len(files)} tests in {test_dir}\n")
+    print(f"Found {len(files)} tests in {test_dir}, {len(OPTION_SETS)} option sets each\n")
     
     passed = 0
     failed = 0
     
-    for f in files:
+    runs = [(f, options) for f in files for options in OPTION_SETS]
+    for f, options in runs:
         filepath = os.path.join(test_dir, f)
         base_name = f[:-2]  # remove .c
         output_c = os.path.join(test_dir, f"{base_name}_min.c")
         
-        print(f"Running test: {f}...", end=" ")
+        print(f"Running test: {f} {options}".rstrip() + "...", end=" ")
         
         # 1. Run Minifier using venv python
-        cmd_minify = f"./venv/bin/python3 minify.py {filepath} > {output_c}"
+        cmd_minify = f"./venv/bin/python3 minify.py {filepath} {options} > {output_c}"
         res = run_cmd(cmd_minify)
         if res.returncode != 0:
             print(f"FAILED (Minifier Error)\n{res.stderr}")
@@ -76,7 +87,19 @@ def main():
             os.remove(output_c)
         passed += 1
     
-    print(f"\nSummary: {passed}/{len(files)} passed.")
+    # Checks of the minifier's internals, one script each
+    scripts = sorted([f for f in os.listdir(test_dir) if f.startswith("test_") and f.endswith(".py")])
+    for f in scripts:
+        print(f"Running check: {f}...", end=" ")
+        res = run_cmd(f"./venv/bin/python3 {os.path.join(test_dir, f)}")
+        if res.returncode != 0:
+            print(f"FAILED\n{res.stdout}{res.stderr}")
+            failed += 1
+            continue
+        print("PASSED")
+        passed += 1
+    
+    print(f"\nSummary: {passed}/{len(runs) + len(scripts)} passed.")
     if failed > 0:
         exit(1)
 
@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+"""
+Minifier daemon over a local Unix domain socket
+
+Keeps the tree-sitter Language and one Parser per connection thread
+resident, so editor and incremental-build integrations pay no start-up
+cost per file.
+
+Protocol (every message, in both directions):
+    <u32 header length><JSON header><u32 body length><body bytes>
+All lengths are big-endian. Requests:
+    {"op": "minify", "rename": true}   body = C source bytes (any ASCII-compatible encoding)
+        optional: "dead_code": true, "literals": true, "name_order": "declaration"
+        (the --remove-dead-code, --compact-literals passes and allocate_region()'s order);
+        flags must be booleans and name_order one of minify.NAME_ORDERS, else an error
+    {"op": "stats"}                    body = empty
+Responses:
+    {"ok": true, ...}                  body = minified source / empty
+    {"ok": false, "error": "..."}      body = empty
+A connection may carry any number of requests.
+
+Usage:
+    python3 server.py serve [--socket PATH] [--cache-dir DIR]
+    python3 server.py client [--socket PATH] [--no-rename] [--remove-dead-code]
+                             [--compact-literals] [--name-order uses|declaration] <file.c>
+    python3 server.py stats [--socket PATH]
+"""
+
+import argparse
+import json
+import os
+import signal
+import socket
+import socketserver
+import stat
+import struct
+import sys
+import threading
+import time
+from collections import deque
+
+import minify
+
+DEFAULT_SOCKET = '/tmp/cminify.sock'
+
+# Upper bound for a single header or body, to reject garbage length prefixes
+MAX_MESSAGE_SIZE = 1 << 30
+# Number of recent request latencies kept for percentiles
+LATENCY_WINDOW = 10000
+# Minify request options that must be JSON booleans when present
+BOOLEAN_OPTIONS = ('rename', 'dead_code', 'literals')
+
+LENGTH = struct.Struct('>I')
+
+
+def recv_exact(sock, size):
+    """Read exactly size bytes, or None if the peer closed first"""
+    chunks = []
+    while size:
+        chunk = sock.recv(min(size, 1 << 20))
+        if not chunk:
+            return None
+        chunks.append(chunk)
+        size -= len(chunk)
+    return b''.join(chunks)
+
+
+def recv_part(sock):
+    """Read one length-prefixed part"""
+    prefix = recv_exact(sock, LENGTH.size)
+    if prefix is None:
+        return None
+    (size,) = LENGTH.unpack(prefix)
+    if size > MAX_MESSAGE_SIZE:
+        raise ValueError(f"Message part too large: {size} bytes")
+    return recv_exact(sock, size)
+
+
+def recv_message(sock):
+    """Read one (header dict, body bytes) message, or None at end of stream"""
+    header = recv_part(sock)
+    if header is None:
+        return None
+    body = recv_part(sock)
+    if body is None:
+        return None
+    return json.loads(header.decode('utf-8')), body
+
+
+def send_message(sock, header, body=b''):
+    """Write one (header dict, body bytes) message"""
+    header = json.dumps(header).encode('utf-8')
+    sock.sendall(LENGTH.pack(len(header)) + header + LENGTH.pack(len(body)) + body)
+
+
+class ServerStats:
+    """Request counters and a rolling latency window, shared by all threads"""
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.started = time.time()
+        self.requests = 0
+        self.errors = 0
+        self.bytes_in = 0
+        self.bytes_out = 0
+        self.latencies = deque(maxlen=LATENCY_WINDOW)  # seconds
+
+    def record(self, seconds, bytes_in, bytes_out, ok):
+        with self.lock:
+            self.requests += 1
+            if not ok:
+                self.errors += 1
+            self.bytes_in += bytes_in
+            self.bytes_out += bytes_out
+            self.latencies.append(seconds)
+
+    def snapshot(self):
+        """Counters plus p50/p90/p99/max latency in milliseconds"""
+        with self.lock:
+            latencies = sorted(self.latencies)
+            snapshot = {
+                'uptime_s': round(time.time() - self.started, 3),
+                'requests': self.requests,
+                'errors': self.errors,
+                'bytes_in': self.bytes_in,
+                'bytes_out': self.bytes_out,
+            }
+        for label, q in (('p50', 0.50), ('p90', 0.90), ('p99', 0.99)):
+            value = latencies[min(len(latencies) - 1, int(q * len(latencies)))] if latencies else 0.0
+            snapshot[f'{label}_ms'] = round(value * 1000, 3)
+        snapshot['max_ms'] = round(latencies[-1] * 1000, 3) if latencies else 0.0
+        return snapshot
+
+
+def check_options(header):
+    """None if a minify request's options are well-formed, else why not
+
+    Flags must be JSON booleans: bool() would read "false" or 0 as set.
+    """
+    for key in BOOLEAN_OPTIONS:
+        if key in header and not isinstance(header[key], bool):
+            return f"'{key}' must be true or false"
+    if header.get('name_order', 'uses') not in minify.NAME_ORDERS:
+        return f"'name_order' must be one of {', '.join(minify.NAME_ORDERS)}"
+    return None
+
+
+class MinifyHandler(socketserver.BaseRequestHandler):
+    """Serves requests on one connection until the client hangs up"""
+    def handle(self):
+        while True:
+            try:
+                message = recv_message(self.request)
+            except (ValueError, OSError) as e:
+                send_message(self.request, {'ok': False, 'error': str(e)})
+                return
+            if message is None:
+                return
+            header, body = message
+            if not isinstance(header, dict):
+                send_message(self.request, {'ok': False, 'error': 'Header must be a JSON object'})
+                continue
+            op = header.get('op')
+            if op == 'minify':
+                self.handle_minify(header, body)
+            elif op == 'stats':
+                snapshot = self.server.stats.snapshot()
+                if self.server.cache is not None:
+                    snapshot['cache'] = self.server.cache.stats()
+                send_message(self.request, dict(ok=True, **snapshot))
+            else:
+                send_message(self.request, {'ok': False, 'error': f"Unknown op '{op}'"})
+
+    def handle_minify(self, header, body):
+        error = check_options(header)
+        if error:
+            send_message(self.request, {'ok': False, 'error': error})
+            return
+        start = time.perf_counter()
+        try:
+            passes = {'remove_dead_code': header.get('dead_code', False),
+                      'compact_literals': header.get('literals', False),
+                      'name_order': header.get('name_order', 'uses')}
+            # Each connection thread parses with its own parser (minify.get_parser())
+            if self.server.cache is not None:
+                result = self.server.cache.minify(body, header.get('rename'), **passes)
+            else:
+                result = self.server.session.minify(body, header.get('rename'), **passes)
+        except Exception as e:
+            self.server.stats.record(time.perf_counter() - start, len(body), 0, False)
+            send_message(self.request, {'ok': False, 'error': f"{type(e).__name__}: {e}"})
+            return
+        self.server.stats.record(time.perf_counter() - start, len(body), len(result), True)
+        send_message(self.request, {'ok': True}, result)
+
+
+def remove_stale_socket(path):
+    """Unlink a socket left behind by a server that is gone
+
+    Anything else at path, a live server's socket included, raises
+    FileExistsError rather than being removed.
+    """
+    try:
+        st = os.lstat(path)
+    except FileNotFoundError:
+        return
+    if not stat.S_ISSOCK(st.st_mode):
+        raise FileExistsError(f"{path} exists and is not a socket")
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as probe:
+        try:
+            probe.connect(path)
+        except ConnectionRefusedError:
+            os.unlink(path)
+            return
+    raise FileExistsError(f"A server is already listening on {path}")
+
+
+class MinifyServer(socketserver.ThreadingUnixStreamServer):
+    daemon_threads = True
+
+    def __init__(self, path, cache_dir=None):
+        remove_stale_socket(path)
+        super().__init__(path, MinifyHandler)
+        self.stats = ServerStats()
+        self.session = minify.MinifierSession()
+        self.cache = None
+        if cache_dir:
+            import cache
+            self.cache = cache.ResultCache(cache_dir)
+        # Warm the shared language before the first request arrives
+        minify.get_language()
+
+
+def request(socket_path, header, body=b''):
+    """Send one request and return (header, body) of the response"""
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(socket_path)
+        send_message(sock, header, body)
+        response = recv_message(sock)
+    if response is None:
+        raise ConnectionError('Server closed the connection')
+    return response
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='C minifier daemon')
+    commands = parser.add_subparsers(dest='command', required=True)
+    serve = commands.add_parser('serve', help='run the daemon')
+    serve.add_argument('--cache-dir', default=None, help='on-disk result cache directory')
+    client = commands.add_parser('client', help='minify a file through the daemon')
+    client.add_argument('file')
+    client.add_argument('--no-rename', action='store_true', help='disable variable renaming')
+    client.add_argument('--remove-dead-code', action='store_true',
+                        help='drop unreferenced statics and unused locals')
+    client.add_argument('--compact-literals', action='store_true',
+                        help='fold constants and shorten literals')
+    client.add_argument('--name-order', choices=minify.NAME_ORDERS, default='uses',
+                        help='which locals get the shortest names first (default: uses)')
+    stats = commands.add_parser('stats', help='print daemon statistics as JSON')
+    for command in (serve, client, stats):
+        command.add_argument('--socket', default=DEFAULT_SOCKET, help='Unix socket path')
+    args = parser.parse_args(argv)
+
+    if args.command == 'serve':
+        # Stop cleanly (and remove the socket) on SIGTERM as well as Ctrl-C
+        signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+        try:
+            server = MinifyServer(args.socket, args.cache_dir)
+        except OSError as e:
+            print(f"Error: {e}", file=sys.stderr)
+            return 1
+        with server:
+            print(f"Listening on {args.socket}", file=sys.stderr)
+            try:
+                server.serve_forever()
+            except KeyboardInterrupt:
+                pass
+            finally:
+                os.unlink(args.socket)
+        return 0
+
+    if args.command == 'stats':
+        header, _ = request(args.socket, {'op': 'stats'})
+        print(json.dumps(header, indent=2))
+        return 0
+
+    with open(args.file, 'rb') as f:
+        source = f.read()
+    header, body = request(args.socket, {'op': 'minify', 'rename': not args.no_rename,
+                                         'dead_code': args.remove_dead_code,
+                                         'literals': args.compact_literals,
+                                         'name_order': args.name_order}, source)
+    if not header.get('ok'):
+        print(f"Error: {header.get('error')}", file=sys.stderr)
+        return 1
+    sys.stdout.buffer.write(body + b'\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
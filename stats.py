@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+Per-phase profiling for the C minifier
+
+Runs the phases of CMinifier.minify() one at a time and reports:
+- wall time and net allocated memory blocks per phase (plus the
+  tracemalloc peak when tracing, e.g. under PYTHONTRACEMALLOC=1)
+- AST nodes, identifiers, scopes pushed and replacements
+- bytes saved by comment removal, renaming, dead code removal, literal
+  compaction and whitespace
+- the slowest top-level declarations, to find pathological functions
+
+Only profile() does any of this, so plain minification pays nothing.
+
+Usage: python3 stats.py [--json FILE] <file.c>...
+"""
+
+import argparse
+import json
+import sys
+import time
+import tracemalloc
+
+import minify
+
+PHASES = ('parse', 'walk', 'resolve', 'emit')
+# Slowest top-level declarations kept per report
+TOP_DECLARATIONS = 10
+
+
+class Phase:
+    """Context manager adding one phase's time and allocations to a report"""
+    def __init__(self, phases, name):
+        self.record = phases.setdefault(name, {'seconds': 0.0, 'blocks': 0})
+
+    def __enter__(self):
+        if tracemalloc.is_tracing():
+            tracemalloc.reset_peak()
+        self.blocks = sys.getallocatedblocks()
+        self.start = time.perf_counter()
+        return self
+
+    def __exit__(self, *exc):
+        self.record['seconds'] += time.perf_counter() - self.start
+        self.record['blocks'] += sys.getallocatedblocks() - self.blocks
+        if tracemalloc.is_tracing():
+            peak = tracemalloc.get_traced_memory()[1]
+            self.record['peak_bytes'] = max(self.record.get('peak_bytes', 0), peak)
+        return False
+
+
+def declaration_name(node, source_bytes):
+    """Name of a top-level function or variable, else its node type"""
+    declarator = node.child_by_field_name('declarator')
+    while declarator is not None and declarator.type != 'identifier':
+        inner = declarator.child_by_field_name('declarator')
+        if inner is None:
+            break
+        declarator = inner
+    if declarator is not None and declarator.type == 'identifier':
+        return bytes(source_bytes[declarator.start_byte:declarator.end_byte]).decode('utf-8', 'replace')
+    return node.type
+
+
+def outermost(spans, outside=()):
+    """The spans not inside another one of spans or of outside, in order"""
+    kept = []
+    end = -1
+    for span in sorted(set(spans) | set(outside), key=lambda span: (span[0], -span[1])):
+        if span[1] <= end:
+            continue
+        end = span[1]
+        if span not in outside:
+            kept.append(span)
+    return kept
+
+
+def emitted_bytes(minifier, spans):
+    """Bytes the subtrees at spans emit as written: what a pass that replaced them saved"""
+    root = minifier.tree.root_node
+    total = 0
+    for start, end in spans:
+        emitter = minify.TokenEmitter(minifier.source_bytes, minify.EditList())
+        emitter.emit(root.descendant_for_byte_range(start, end))
+        total += len(emitter.getvalue())
+    return total
+
+
+def profile(source, parser=None, enable_renaming=None, sink=None, name=None,
+            remove_dead_code=False, compact_literals=False, verify=False, name_order='uses',
+            header=False):
+    """Minify source phase by phase; returns (output, report)
+
+    With a sink the output is streamed there and the first value is the
+    number of bytes written, as with CMinifier.minify_to(). With verify,
+    the output is checked against the source (see verify.py) and the
+    report's 'divergence' holds the first difference, or None.
+    """
+    if isinstance(source, str):
+        source = source.encode('utf-8')
+    phases = {}
+    parser = parser or minify.get_parser()
+    with Phase(phases, 'parse'):
+        tree = parser.parse(source)
+    minifier = minify.CMinifier(source, parser, enable_renaming=enable_renaming, tree=tree,
+                                remove_dead_code=remove_dead_code,
+                                compact_literals=compact_literals, name_order=name_order,
+                                header=header)
+    children = tree.root_node.children
+
+    # Walk and emit top-level declarations one by one to time each of them;
+    # the result is the same as one pass over the whole tree
+    declarations = []
+    events = minifier.events
+    with Phase(phases, 'walk'):
+        for child in children:
+            first = len(events)
+            start = time.perf_counter()
+            minifier.walk(child)
+            declarations.append([child, time.perf_counter() - start, first, len(events)])
+
+    if remove_dead_code:
+        with Phase(phases, 'deadcode'):
+            minifier.eliminate_dead_code()
+
+    with Phase(phases, 'resolve'):
+        if minifier.enable_renaming:
+            minifier.resolve_identifiers()
+
+    if compact_literals:
+        with Phase(phases, 'literals'):
+            minifier.fold_literals()
+
+    with Phase(phases, 'emit'):
+        # Verification needs the output itself, so it is not streamed
+        emitter = minify.TokenEmitter(minifier.source_bytes, minifier.replacements,
+                                      None if verify else sink,
+                                      skip=minifier.skip, folded=minifier.folded)
+        for declaration in declarations:
+            start = time.perf_counter()
+            emitter.emit(declaration[0])
+            declaration[1] += time.perf_counter() - start
+        if sink is None or verify:
+            output = emitter.getvalue()
+            out_bytes = len(output)
+        else:
+            emitter.flush()
+            output = out_bytes = emitter.written
+
+    divergence = None
+    if verify:
+        import verify as verifier
+        with Phase(phases, 'verify'):
+            divergence = verifier.verify(minifier, output, parser)
+        if sink is not None:
+            getattr(sink, 'write', sink)(output)
+            output = out_bytes
+
+    in_bytes = len(source)
+    comment_bytes = minifier.removals.saved_bytes()
+    rename_bytes = minifier.replacements.saved_bytes()
+    # Each pass's saving is measured against emitting its subtrees as
+    # written, so 'whitespace' keeps only what the emitter itself dropped
+    dead_bytes = literal_bytes = 0
+    if minifier.skip:
+        dead_bytes = emitted_bytes(minifier, outermost(minifier.skip))
+    if minifier.folded:
+        folded = outermost(minifier.folded, minifier.skip or ())
+        literal_bytes = (emitted_bytes(minifier, folded)
+                         - sum(len(minifier.folded[span][0]) for span in folded))
+    # Counted after dead code removal, as resolve and emit saw them
+    live = minifier.events
+    identifiers = sum(1 for event in live if len(event) > 1)
+
+    declarations.sort(key=lambda d: -d[1])
+    top = []
+    for node, seconds, first, last in declarations[:TOP_DECLARATIONS]:
+        top.append({
+            'name': declaration_name(node, minifier.source_bytes),
+            'type': node.type,
+            'line': node.start_point[0] + 1,
+            'bytes': node.end_byte - node.start_byte,
+            'identifiers': sum(1 for event in events[first:last] if len(event) > 1),
+            'seconds': round(seconds, 6),
+        })
+
+    report = {
+        'files': 1,
+        'input_bytes': in_bytes,
+        'output_bytes': out_bytes,
+        'phases': phases,
+        'counts': {
+            'nodes': tree.root_node.descendant_count,
+            'identifiers': identifiers,
+            'scopes': sum(1 for event in live if event[0] == minify.EV_ENTER),
+            'replacements': len(minifier.replacements),
+            'comments': len(minifier.removals),
+        },
+        'saved_bytes': {
+            'comments': comment_bytes,
+            'renames': rename_bytes,
+            'dead_code': dead_bytes,
+            'literals': literal_bytes,
+            # Everything else: dropped whitespace net of separators and newlines
+            'whitespace': (in_bytes - out_bytes - comment_bytes - rename_bytes
+                           - dead_bytes - literal_bytes),
+        },
+        'declarations': [dict(entry, file=name) for entry in top] if name else top,
+    }
+    if verify:
+        report['divergence'] = divergence
+    return output, report
+
+
+def empty_report():
+    return {
+        'files': 0, 'input_bytes': 0, 'output_bytes': 0,
+        'phases': {phase: {'seconds': 0.0, 'blocks': 0} for phase in PHASES},
+        'counts': {'nodes': 0, 'identifiers': 0, 'scopes': 0, 'replacements': 0, 'comments': 0},
+        'saved_bytes': {'comments': 0, 'renames': 0, 'dead_code': 0, 'literals': 0,
+                        'whitespace': 0},
+        'declarations': [],
+    }
+
+
+def merge(total, report):
+    """Add report into total (both as returned by profile()); returns total"""
+    for key in ('files', 'input_bytes', 'output_bytes'):
+        total[key] += report[key]
+    for phase, record in report['phases'].items():
+        into = total['phases'].setdefault(phase, {'seconds': 0.0, 'blocks': 0})
+        into['seconds'] += record['seconds']
+        into['blocks'] += record['blocks']
+        if 'peak_bytes' in record:
+            into['peak_bytes'] = max(into.get('peak_bytes', 0), record['peak_bytes'])
+    for group in ('counts', 'saved_bytes'):
+        for key, value in report[group].items():
+            total[group][key] = total[group].get(key, 0) + value
+    total['declarations'] = sorted(total['declarations'] + report['declarations'],
+                                   key=lambda d: -d['seconds'])[:TOP_DECLARATIONS]
+    return total
+
+
+def finalize(report):
+    """Round phase times and add the total, for printing"""
+    for record in report['phases'].values():
+        record['seconds'] = round(record['seconds'], 6)
+    report['total_seconds'] = round(sum(r['seconds'] for r in report['phases'].values()), 6)
+    return report
+
+
+def write_report(report, path='-'):
+    """Write a report as JSON to a file, or to stderr for '-'"""
+    text = json.dumps(finalize(report), indent=2)
+    if path == '-':
+        print(text, file=sys.stderr)
+    else:
+        with open(path, 'w') as f:
+            f.write(text + '\n')
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description='Profile minification phase by phase')
+    parser.add_argument('files', nargs='+')
+    parser.add_argument('--json', default='-', help="report file (default: stderr)")
+    parser.add_argument('--no-rename', action='store_true', help='disable variable renaming')
+    args = parser.parse_args(argv)
+
+    total = empty_report()
+    for path in args.files:
+        _, report = profile(minify.read_source(path),
+                            enable_renaming=False if args.no_rename else None, name=path)
+        merge(total, report)
+    write_report(total, args.json)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,69 @@
+#include <stdio.h>
+
+// Edge case: Declarator shapes and scoping rules
+// Test that every declared name is renamed consistently with its uses
+
+int shared_counter = 7;
+
+static int helper(int unused_name);
+
+static int helper(int amount) {
+    int *amount_ptr = &amount;
+    return *amount_ptr * 2;
+}
+
+int apply(int (*callback)(int), int argument) {
+    return callback(argument);
+}
+
+int main() {
+    int failures = 0;
+
+    // Test 1: Pointer declarator shadowing an outer variable
+    int value = 1;
+    {
+        int *value_ptr = &value;
+        int value = 2;
+        if (*value_ptr != 1 || value != 2) failures++;
+    }
+
+    // Test 2: Initializer that reads an outer variable
+    int total = value;
+    {
+        int inner = total + 1;
+        if (inner != 2) failures++;
+    }
+
+    // Test 3: for-loop variable has its own scope
+    int index = 5;
+    for (int index = 0; index < 3; index++) {
+        total += index;
+    }
+    if (index != 5 || total != 4) failures++;
+
+    // Test 4: Block-scope extern refers to the global
+    {
+        int shared_counter = 100;
+        {
+            extern int shared_counter;
+            if (shared_counter != 7) failures++;
+        }
+        if (shared_counter != 100) failures++;
+    }
+
+    // Test 5: Function pointer variables and parameters
+    int (*function_pointer)(int) = helper;
+    if (apply(function_pointer, 4) != 8) failures++;
+
+    // Test 6: Array declarator with size expression
+    int length = 3;
+    int numbers[3] = {1, 2, 3};
+    int sum = 0;
+    for (int position = 0; position < length; position++) {
+        sum += numbers[position];
+    }
+    if (sum != 6) failures++;
+
+    printf("Failures: %d\n", failures);
+    return failures;
+}
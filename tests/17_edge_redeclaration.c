@@ -0,0 +1,40 @@
+#include <stdio.h>
+
+// Edge case: Locals declared in both arms of a conditional
+// Both arms declare one object, and no other local may share its name
+
+int main() {
+    int result = 0;
+
+    // Test 1: The same local in the #ifndef and #else arms
+#ifndef MINIFY_TEST_UNDEFINED
+    int value = 1;
+#else
+    int value = 2;
+#endif
+    int other = 3;
+    printf("Test 1: %d\n", value + other + other + other);
+    if (value + other + other + other != 10) result = 1;
+
+    // Test 2: Locals never referenced again, declared side by side
+    {
+        int unused_a = 4;
+        int unused_b = 5;
+        int used = 6;
+        printf("Test 2: %d\n", used);
+    }
+
+    // Test 3: Redeclared in a nested block with a sibling declared after it
+    {
+#ifdef MINIFY_TEST_UNDEFINED
+        long count = 7;
+#else
+        long count = 8;
+#endif
+        long total = count * 2;
+        printf("Test 3: %ld\n", total + count);
+        if (total + count != 24) result = 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+
+// Edge case: Definitions dead-code elimination must keep
+// Unused statics and locals may go, but not the types and constants
+// their declarations define, nor anything another file can see
+
+// Test 1: Enumeration constants defined by an unused static
+static enum { RED, GREEN, BLUE } unused_color = RED;
+
+// Test 2: A struct tag defined by an unused static
+static struct config { int width; int height; } unused_config;
+
+// Test 3: A union tag defined by an unused static
+static union number { int i; float f; } unused_number;
+
+// Test 4: Extern declarations and non-static definitions are roots
+extern int shared_counter;
+int shared_counter = 5;
+
+// Test 5: Statics only used by other dead statics
+static int dead_helper(int x) { return x * 2; }
+static int dead_caller(int x) { return dead_helper(x) + 1; }
+
+static int live_helper(int x) { return x + GREEN; }
+
+int main() {
+    int result = 0;
+
+    struct config c = { 3, 4 };
+    printf("Test 1: %d\n", BLUE);
+    if (BLUE != 2) result = 1;
+
+    printf("Test 2: %d\n", c.width * c.height);
+    if (c.width * c.height != 12) result = 1;
+
+    union number n;
+    n.i = 7;
+    printf("Test 3: %d\n", n.i);
+
+    printf("Test 4: %d\n", shared_counter);
+
+    // Test 6: An unused local whose type defines constants of its own
+    enum { LOW = 10, HIGH = 20 } level = LOW;
+    int unused_local = 42;
+    printf("Test 6: %d\n", HIGH + live_helper(0));
+    if (HIGH + live_helper(0) != 21) result = 1;
+
+    return result;
+}
@@ -0,0 +1,54 @@
+#include <stdio.h>
+
+// Edge case: Branches of constant #if conditions
+// Dead arms are dropped from the output and take no part in renaming
+
+#if 0
+static int disabled_counter = 0;
+int disabled_function(int x) { return undefined_helper(x); }
+#endif
+
+static int counter = 1;
+
+#if 1
+static int enabled(int x) { return x + counter; }
+#else
+static int enabled(int x) { return x - disabled_counter; }
+#endif
+
+int main() {
+    int result = 0;
+
+    // Test 1: The #if 1 arm is kept, its #else dropped
+    printf("Test 1: %d\n", enabled(2));
+    if (enabled(2) != 3) result = 1;
+
+    // Test 2: Locals of a dead arm do not clash with live ones
+#if 0
+    int value = 100;
+    int other = value;
+#elif 1
+    int value = 7;
+#else
+    int value = 8;
+#endif
+    int total = value * 2;
+    printf("Test 2: %d\n", total);
+    if (total != 14) result = 1;
+
+    // Test 3: A constant branch after a condition that is not constant
+#ifdef MINIFY_TEST_UNDEFINED
+    total = 0;
+#endif
+#if defined(MINIFY_TEST_UNDEFINED)
+    total = 1;
+#elif 0
+    total = 2;
+#else
+    total = 3;
+#endif
+    printf("Test 3: %d\n", total);
+    if (total != 3) result = 1;
+
+    return result;
+}
@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <string.h>
+
+// Edge case: Constant folding and literal rewriting
+// Folded values, respelled numbers and merged strings must keep their
+// exact values, and must not merge with the tokens next to them
+
+static int table[3 - 1 + 2 * 2];
+
+int main() {
+    int result = 0;
+    int y = 2;
+
+    // Test 1: A hex literal ending in E before '-': never written as 0xE-1
+    int a = 0xE - 1;
+    int b = 0xE - y;
+    int c = 0x1E + 0xE - 0xe;
+    printf("Test 1: %d %d %d\n", a, b, c);
+    if (a != 13 || b != 12 || c != 30) result = 1;
+
+    // Test 2: A fold whose decimal spelling is longer than the expression
+    long big = 1 << 30;
+    long shifted = (1 << 15) * (1 << 14);
+    printf("Test 2: %ld %ld\n", big, shifted);
+    if (big != 1073741824L || shifted != 536870912L) result = 1;
+
+    // Test 3: Negative results and their neighbours
+    int neg = 1 - 4;
+    int neg2 = -(2 * 3);
+    int sub = 10 - -(1 + 1);
+    int idx = sizeof(table) / sizeof(table[0]) - (5 - 1);
+    printf("Test 3: %d %d %d %d\n", neg, neg2, sub, idx);
+    if (neg != -3 || neg2 != -6 || sub != 12 || idx != 2) result = 1;
+
+    // Test 4: Division and remainder truncate toward zero
+    int q = -7 / 2;
+    int r = -7 % 2;
+    int p = (7 / 2) % 3;
+    printf("Test 4: %d %d %d\n", q, r, p);
+    if (q != -3 || r != -1 || p != 0) result = 1;
+
+    // Test 5: Strings merged next to hex and octal escapes
+    const char *s1 = "\x41" "BC";
+    const char *s2 = "\x4" "1";
+    const char *s3 = "\1" "23";
+    const char *s4 = "\x41" "\x42" "f";
+    printf("Test 5: %s %d %d %d %s\n", s1, s2[0], s3[0], (int)strlen(s3), s4);
+    if (strcmp(s1, "ABC") != 0 || s2[0] != 4 || s2[1] != '1' || s3[0] != 1
+            || strlen(s3) != 3 || strcmp(s4, "ABf") != 0) result = 1;
+
+    // Test 6: Respelled numbers keep their type and value
+    unsigned long long wide = 0x00000010ULL;
+    double half = 0.50;
+    float one = 1.000f;
+    char letter = '\x41';
+    printf("Test 6: %llu %.2f %.1f %c\n", wide, half, one, letter);
+    if (wide != 16 || half != 0.5 || one != 1.0f || letter != 'A') result = 1;
+
+    return result;
+}
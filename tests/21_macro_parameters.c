@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <string.h>
+
+// Edge case: Renamed parameters of function-like macros
+// '#' and '##' act on the argument, so renaming their operands is safe;
+// names of the body that are not parameters must never be captured
+
+#define STRINGIFY(value) #value
+#define XSTRINGIFY(value) STRINGIFY(value)
+#define PASTE(prefix, suffix) prefix##suffix
+#define PASTE3(first, second, third) first ## second ## third
+#define FIELD(object, member) ((object).member)
+#define LABELLED(name, count) printf("%s=%d\n", #name, (count) + a)
+#define SPLIT(left, \
+              right) ((left) - \
+                      (right))
+#define PREFIXED(text) L ## text
+#define VARIADIC(format, ...) printf(format, __VA_ARGS__)
+
+struct point { int member; int x; };
+
+// Named in a macro body, so it must keep its name
+int a = 1;
+
+int main() {
+    int result = 0;
+    int counter1 = 5;
+    struct point pt = { 7, 8 };
+
+    // Test 1: Stringified parameters keep the argument's spelling
+    printf("Test 1: %s %s\n", STRINGIFY(hello world), XSTRINGIFY(__LINE__ + 0));
+    if (strcmp(STRINGIFY(hello world), "hello world") != 0) result = 1;
+
+    // Test 2: Pasted parameters
+    printf("Test 2: %d %d\n", PASTE(1, 2), PASTE3(3, 4, 5));
+    if (PASTE(1, 2) != 12 || PASTE3(3, 4, 5) != 345) result = 1;
+    PASTE(put, s)("Test 2: pasted callee");
+
+    // Test 3: A member named like a parameter
+    printf("Test 3: %d\n", FIELD(pt, x));
+    if (FIELD(pt, member) != 7) result = 1;
+
+    // Test 4: A body name ('a') that a renamed parameter must not take
+    LABELLED(answer, 41);
+
+    // Test 5: Parameters across line continuations
+    printf("Test 5: %d\n", SPLIT(10, 3));
+    if (SPLIT(10, 3) != 7) result = 1;
+
+    // Test 6: Pasting a prefix onto a string literal, and variadic arguments
+    printf("Test 6: %d\n", (int)sizeof(PREFIXED("ab")[0]) > 1);
+    VARIADIC("Test 7: %d %d\n", a, counter1);
+
+    return result;
+}
@@ -0,0 +1,277 @@
+#include <stdio.h>
+
+// Edge case: Large literal-only initializer lists
+// Lists over 4 KB are compacted in bulk; a char array of explicit size may
+// become a string, even one its terminating null does not fit in
+
+// Test 1: Exactly as many elements as the array holds: no room for a null
+static const unsigned char exact[1000] = {
+    0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x3F, 0x3F,
+    0x3D, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A, 0x00, 0x31, 0x39, 0x5E,
+    0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x22, 0x5C, 0x27, 0x50, 0x75, 0x1A,
+    0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56,
+    0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12,
+    0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E,
+    0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A,
+    0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46,
+    0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02,
+    0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E,
+    0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A,
+    0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36,
+    0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72,
+    0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E,
+    0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A,
+    0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26,
+    0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62,
+    0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E,
+    0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A,
+    0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16,
+    0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52,
+    0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E,
+    0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A,
+    0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06,
+    0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42,
+    0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E,
+    0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A,
+    0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76,
+    0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32,
+    0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E,
+    0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A,
+    0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66,
+    0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22,
+    0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E,
+    0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A,
+    0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56,
+    0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12,
+    0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E,
+    0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A,
+    0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46,
+    0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02,
+    0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E,
+    0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A,
+    0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36,
+    0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72,
+    0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E,
+    0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A,
+    0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26,
+    0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62,
+    0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E,
+    0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A,
+    0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16,
+    0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52,
+    0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E,
+    0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A,
+    0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06,
+    0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42,
+    0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E,
+    0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A,
+    0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76,
+    0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32,
+    0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E,
+    0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A,
+    0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66,
+    0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22,
+    0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E,
+    0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A,
+    0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56,
+    0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12,
+    0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E,
+    0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A,
+    0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46,
+    0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02,
+    0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E,
+    0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A,
+    0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36,
+    0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72,
+    0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E,
+    0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A,
+    0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26,
+    0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62,
+    0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E,
+    0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A,
+    0x7F, 0x24, 0x49, 0x6E,
+};
+
+// Test 2: Fewer elements than the array holds: the rest stays zero
+static const char padded[703] = {
+    /* leading comment */
+    0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x3F, 0x3F,
+    0x3D, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A, 0x00, 0x31, 0x39, 0x5E,
+    0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x22, 0x5C, 0x27, 0x50, 0x75, 0x1A,
+    0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56,
+    0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12,
+    0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E,
+    0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A,
+    0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46,
+    0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02,
+    0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E,
+    0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A,
+    0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36,
+    0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72,
+    0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E,
+    0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A,
+    0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26,
+    0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62,
+    0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E,
+    0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A,
+    0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16,
+    0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52,
+    0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E,
+    0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A,
+    0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06,
+    0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42,
+    0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E,
+    0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A,
+    0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76,
+    0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32,
+    0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E,
+    0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A,
+    0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66,
+    0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22,
+    0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E,
+    0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A,
+    0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56,
+    0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12,
+    0x37, 0x5C, 0x01, 0x26, 0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E,
+    0x73, 0x18, 0x3D, 0x62, 0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A,
+    0x2F, 0x54, 0x79, 0x1E, 0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46,
+    0x6B, 0x10, 0x35, 0x5A, 0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02,
+    0x27, 0x4C, 0x71, 0x16, 0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E,
+    0x63, 0x08, 0x2D, 0x52, 0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A,
+    0x1F, 0x44, 0x69, 0x0E, 0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36,
+    0x5B, 0x00, 0x25, 0x4A, 0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72,
+    0x17, 0x3C, 0x61, 0x06, 0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E,
+    0x53, 0x78, 0x1D, 0x42, 0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A,
+    0x0F, 0x34, 0x59, 0x7E, 0x23, 0x48, 0x6D, 0x12, 0x37, 0x5C, 0x01, 0x26,
+    0x4B, 0x70, 0x15, 0x3A, 0x5F, 0x04, 0x29, 0x4E, 0x73, 0x18, 0x3D, 0x62,
+    0x07, 0x2C, 0x51, 0x76, 0x1B, 0x40, 0x65, 0x0A, 0x2F, 0x54, 0x79, 0x1E,
+    0x43, 0x68, 0x0D, 0x32, 0x57, 0x7C, 0x21, 0x46, 0x6B, 0x10, 0x35, 0x5A,
+    0x7F, 0x24, 0x49, 0x6E, 0x13, 0x38, 0x5D, 0x02, 0x27, 0x4C, 0x71, 0x16,
+    0x3B, 0x60, 0x05, 0x2A, 0x4F, 0x74, 0x19, 0x3E, 0x63, 0x08, 0x2D, 0x52,
+    0x77, 0x1C, 0x41, 0x66, 0x0B, 0x30, 0x55, 0x7A, 0x1F, 0x44, 0x69, 0x0E,
+    0x33, 0x58, 0x7D, 0x22, 0x47, 0x6C, 0x11, 0x36, 0x5B, 0x00, 0x25, 0x4A,
+    0x6F, 0x14, 0x39, 0x5E, 0x03, 0x28, 0x4D, 0x72, 0x17, 0x3C, 0x61, 0x06,
+    0x2B, 0x50, 0x75, 0x1A, 0x3F, 0x64, 0x09, 0x2E, 0x53, 0x78, 0x1D, 0x42,
+    0x67, 0x0C, 0x31, 0x56, 0x7B, 0x20, 0x45, 0x6A, 0x0F, 0x34, 0x59, 0x7E,
+    0x23, 0x48, 0x6D, 0x12,
+};
+
+// Test 3: Numbers respelled in bulk
+static const int numbers[] = {
+    0x000000, 0x00001EEF, 0x00003DDE, 0x00005CCD, 0x00007BBC, 0x00009AAB, 0x0000B99A, 0x0000D889, 0x0000F778, 0x00001667,
+    0x00003556, 0x00005445, 0x00007334, 0x00009223, 0x0000B112, 0x0000D001, 0x0000EEF0, 0x0000DDF, 0x00002CCE, 0x00004BBD,
+    0x00006AAC, 0x0000899B, 0x0000A88A, 0x0000C779, 0x0000E668, 0x0000557, 0x00002446, 0x00004335, 0x00006224, 0x00008113,
+    0x0000A002, 0x0000BEF1, 0x0000DDE0, 0x0000FCCF, 0x00001BBE, 0x00003AAD, 0x0000599C, 0x0000788B, 0x0000977A, 0x0000B669,
+    0x0000D558, 0x0000F447, 0x00001336, 0x00003225, 0x00005114, 0x00007003, 0x00008EF2, 0x0000ADE1, 0x0000CCD0, 0x0000EBBF,
+    0x0000AAE, 0x0000299D, 0x0000488C, 0x0000677B, 0x0000866A, 0x0000A559, 0x0000C448, 0x0000E337, 0x0000226, 0x00002115,
+    0x00004004, 0x00005EF3, 0x00007DE2, 0x00009CD1, 0x0000BBC0, 0x0000DAAF, 0x0000F99E, 0x0000188D, 0x0000377C, 0x0000566B,
+    0x0000755A, 0x00009449, 0x0000B338, 0x0000D227, 0x0000F116, 0x00001005, 0x00002EF4, 0x00004DE3, 0x00006CD2, 0x00008BC1,
+    0x0000AAB0, 0x0000C99F, 0x0000E88E, 0x000077D, 0x0000266C, 0x0000455B, 0x0000644A, 0x00008339, 0x0000A228, 0x0000C117,
+    0x0000E006, 0x0000FEF5, 0x00001DE4, 0x00003CD3, 0x00005BC2, 0x00007AB1, 0x000099A0, 0x0000B88F, 0x0000D77E, 0x0000F66D,
+    0x0000155C, 0x0000344B, 0x0000533A, 0x00007229, 0x00009118, 0x0000B007, 0x0000CEF6, 0x0000EDE5, 0x0000CD4, 0x00002BC3,
+    0x00004AB2, 0x000069A1, 0x00008890, 0x0000A77F, 0x0000C66E, 0x0000E55D, 0x000044C, 0x0000233B, 0x0000422A, 0x00006119,
+    0x00008008, 0x00009EF7, 0x0000BDE6, 0x0000DCD5, 0x0000FBC4, 0x00001AB3, 0x000039A2, 0x00005891, 0x00007780, 0x0000966F,
+    0x0000B55E, 0x0000D44D, 0x0000F33C, 0x0000122B, 0x0000311A, 0x00005009, 0x00006EF8, 0x00008DE7, 0x0000ACD6, 0x0000CBC5,
+    0x0000EAB4, 0x00009A3, 0x00002892, 0x00004781, 0x00006670, 0x0000855F, 0x0000A44E, 0x0000C33D, 0x0000E22C, 0x000011B,
+    0x0000200A, 0x00003EF9, 0x00005DE8, 0x00007CD7, 0x00009BC6, 0x0000BAB5, 0x0000D9A4, 0x0000F893, 0x00001782, 0x00003671,
+    0x00005560, 0x0000744F, 0x0000933E, 0x0000B22D, 0x0000D11C, 0x0000F00B, 0x0000EFA, 0x00002DE9, 0x00004CD8, 0x00006BC7,
+    0x00008AB6, 0x0000A9A5, 0x0000C894, 0x0000E783, 0x0000672, 0x00002561, 0x00004450, 0x0000633F, 0x0000822E, 0x0000A11D,
+    0x0000C00C, 0x0000DEFB, 0x0000FDEA, 0x00001CD9, 0x00003BC8, 0x00005AB7, 0x000079A6, 0x00009895, 0x0000B784, 0x0000D673,
+    0x0000F562, 0x00001451, 0x00003340, 0x0000522F, 0x0000711E, 0x0000900D, 0x0000AEFC, 0x0000CDEB, 0x0000ECDA, 0x0000BC9,
+    0x00002AB8, 0x000049A7, 0x00006896, 0x00008785, 0x0000A674, 0x0000C563, 0x0000E452, 0x0000341, 0x00002230, 0x0000411F,
+    0x0000600E, 0x00007EFD, 0x00009DEC, 0x0000BCDB, 0x0000DBCA, 0x0000FAB9, 0x000019A8, 0x00003897, 0x00005786, 0x00007675,
+    0x00009564, 0x0000B453, 0x0000D342, 0x0000F231, 0x00001120, 0x0000300F, 0x00004EFE, 0x00006DED, 0x00008CDC, 0x0000ABCB,
+    0x0000CABA, 0x0000E9A9, 0x0000898, 0x00002787, 0x00004676, 0x00006565, 0x00008454, 0x0000A343, 0x0000C232, 0x0000E121,
+    0x000010, 0x00001EFF, 0x00003DEE, 0x00005CDD, 0x00007BCC, 0x00009ABB, 0x0000B9AA, 0x0000D899, 0x0000F788, 0x00001677,
+    0x00003566, 0x00005455, 0x00007344, 0x00009233, 0x0000B122, 0x0000D011, 0x0000EF00, 0x0000DEF, 0x00002CDE, 0x00004BCD,
+    0x00006ABC, 0x000089AB, 0x0000A89A, 0x0000C789, 0x0000E678, 0x0000567, 0x00002456, 0x00004345, 0x00006234, 0x00008123,
+    0x0000A012, 0x0000BF01, 0x0000DDF0, 0x0000FCDF, 0x00001BCE, 0x00003ABD, 0x000059AC, 0x0000789B, 0x0000978A, 0x0000B679,
+    0x0000D568, 0x0000F457, 0x00001346, 0x00003235, 0x00005124, 0x00007013, 0x00008F02, 0x0000ADF1, 0x0000CCE0, 0x0000EBCF,
+    0x0000ABE, 0x000029AD, 0x0000489C, 0x0000678B, 0x0000867A, 0x0000A569, 0x0000C458, 0x0000E347, 0x0000236, 0x00002125,
+    0x00004014, 0x00005F03, 0x00007DF2, 0x00009CE1, 0x0000BBD0, 0x0000DABF, 0x0000F9AE, 0x0000189D, 0x0000378C, 0x0000567B,
+    0x0000756A, 0x00009459, 0x0000B348, 0x0000D237, 0x0000F126, 0x00001015, 0x00002F04, 0x00004DF3, 0x00006CE2, 0x00008BD1,
+    0x0000AAC0, 0x0000C9AF, 0x0000E89E, 0x000078D, 0x0000267C, 0x0000456B, 0x0000645A, 0x00008349, 0x0000A238, 0x0000C127,
+    0x0000E016, 0x0000FF05, 0x00001DF4, 0x00003CE3, 0x00005BD2, 0x00007AC1, 0x000099B0, 0x0000B89F, 0x0000D78E, 0x0000F67D,
+    0x0000156C, 0x0000345B, 0x0000534A, 0x00007239, 0x00009128, 0x0000B017, 0x0000CF06, 0x0000EDF5, 0x0000CE4, 0x00002BD3,
+    0x00004AC2, 0x000069B1, 0x000088A0, 0x0000A78F, 0x0000C67E, 0x0000E56D, 0x000045C, 0x0000234B, 0x0000423A, 0x00006129,
+    0x00008018, 0x00009F07, 0x0000BDF6, 0x0000DCE5, 0x0000FBD4, 0x00001AC3, 0x000039B2, 0x000058A1, 0x00007790, 0x0000967F,
+    0x0000B56E, 0x0000D45D, 0x0000F34C, 0x0000123B, 0x0000312A, 0x00005019, 0x00006F08, 0x00008DF7, 0x0000ACE6, 0x0000CBD5,
+    0x0000EAC4, 0x00009B3, 0x000028A2, 0x00004791, 0x00006680, 0x0000856F, 0x0000A45E, 0x0000C34D, 0x0000E23C, 0x000012B,
+    0x0000201A, 0x00003F09, 0x00005DF8, 0x00007CE7, 0x00009BD6, 0x0000BAC5, 0x0000D9B4, 0x0000F8A3, 0x00001792, 0x00003681,
+    0x00005570, 0x0000745F, 0x0000934E, 0x0000B23D, 0x0000D12C, 0x0000F01B, 0x0000F0A, 0x00002DF9, 0x00004CE8, 0x00006BD7,
+    0x00008AC6, 0x0000A9B5, 0x0000C8A4, 0x0000E793, 0x0000682, 0x00002571, 0x00004460, 0x0000634F, 0x0000823E, 0x0000A12D,
+    0x0000C01C, 0x0000DF0B, 0x0000FDFA, 0x00001CE9, 0x00003BD8, 0x00005AC7, 0x000079B6, 0x000098A5, 0x0000B794, 0x0000D683,
+    0x0000F572, 0x00001461, 0x00003350, 0x0000523F, 0x0000712E, 0x0000901D, 0x0000AF0C, 0x0000CDFB, 0x0000ECEA, 0x0000BD9,
+    0x00002AC8, 0x000049B7, 0x000068A6, 0x00008795, 0x0000A684, 0x0000C573, 0x0000E462, 0x0000351, 0x00002240, 0x0000412F,
+    0x0000601E, 0x00007F0D, 0x00009DFC, 0x0000BCEB, 0x0000DBDA, 0x0000FAC9, 0x000019B8, 0x000038A7, 0x00005796, 0x00007685,
+    0x00009574, 0x0000B463, 0x0000D352, 0x0000F241, 0x00001130, 0x0000301F, 0x00004F0E, 0x00006DFD, 0x00008CEC, 0x0000ABDB,
+    0x0000CACA, 0x0000E9B9, 0x00008A8, 0x00002797, 0x00004686, 0x00006575, 0x00008464, 0x0000A353, 0x0000C242, 0x0000E131,
+    0x000020, 0x00001F0F, 0x00003DFE, 0x00005CED, 0x00007BDC, 0x00009ACB, 0x0000B9BA, 0x0000D8A9, 0x0000F798, 0x00001687,
+    0x00003576, 0x00005465, 0x00007354, 0x00009243, 0x0000B132, 0x0000D021, 0x0000EF10, 0x0000DFF, 0x00002CEE, 0x00004BDD,
+    0x00006ACC, 0x000089BB, 0x0000A8AA, 0x0000C799, 0x0000E688, 0x0000577, 0x00002466, 0x00004355, 0x00006244, 0x00008133,
+    0x0000A022, 0x0000BF11, 0x0000DE00, 0x0000FCEF, 0x00001BDE, 0x00003ACD, 0x000059BC, 0x000078AB, 0x0000979A, 0x0000B689,
+    0x0000D578, 0x0000F467, 0x00001356, 0x00003245, 0x00005134, 0x00007023, 0x00008F12, 0x0000AE01, 0x0000CCF0, 0x0000EBDF,
+    0x0000ACE, 0x000029BD, 0x000048AC, 0x0000679B, 0x0000868A, 0x0000A579, 0x0000C468, 0x0000E357, 0x0000246, 0x00002135,
+    0x00004024, 0x00005F13, 0x00007E02, 0x00009CF1, 0x0000BBE0, 0x0000DACF, 0x0000F9BE, 0x000018AD, 0x0000379C, 0x0000568B,
+    0x0000757A, 0x00009469, 0x0000B358, 0x0000D247, 0x0000F136, 0x00001025, 0x00002F14, 0x00004E03, 0x00006CF2, 0x00008BE1,
+    0x0000AAD0, 0x0000C9BF, 0x0000E8AE, 0x000079D, 0x0000268C, 0x0000457B, 0x0000646A, 0x00008359, 0x0000A248, 0x0000C137,
+    0x0000E026, 0x0000FF15, 0x00001E04, 0x00003CF3, 0x00005BE2, 0x00007AD1, 0x000099C0, 0x0000B8AF, 0x0000D79E, 0x0000F68D,
+    0x0000157C, 0x0000346B, 0x0000535A, 0x00007249, 0x00009138, 0x0000B027, 0x0000CF16, 0x0000EE05, 0x0000CF4, 0x00002BE3,
+    0x00004AD2, 0x000069C1, 0x000088B0, 0x0000A79F, 0x0000C68E, 0x0000E57D, 0x000046C, 0x0000235B, 0x0000424A, 0x00006139,
+    0x00008028, 0x00009F17, 0x0000BE06, 0x0000DCF5, 0x0000FBE4, 0x00001AD3, 0x000039C2, 0x000058B1, 0x000077A0, 0x0000968F,
+    0x0000B57E, 0x0000D46D, 0x0000F35C, 0x0000124B, 0x0000313A, 0x00005029, 0x00006F18, 0x00008E07, 0x0000ACF6, 0x0000CBE5,
+    0x0000EAD4, 0x00009C3, 0x000028B2, 0x000047A1, 0x00006690, 0x0000857F, 0x0000A46E, 0x0000C35D, 0x0000E24C, 0x000013B,
+    0x0000202A, 0x00003F19, 0x00005E08, 0x00007CF7, 0x00009BE6, 0x0000BAD5, 0x0000D9C4, 0x0000F8B3, 0x000017A2, 0x00003691,
+    0x00005580, 0x0000746F, 0x0000935E, 0x0000B24D, 0x0000D13C, 0x0000F02B, 0x0000F1A, 0x00002E09, 0x00004CF8, 0x00006BE7,
+    0x00008AD6, 0x0000A9C5, 0x0000C8B4, 0x0000E7A3, 0x0000692, 0x00002581, 0x00004470, 0x0000635F, 0x0000824E, 0x0000A13D,
+    0x0000C02C, 0x0000DF1B, 0x0000FE0A, 0x00001CF9, 0x00003BE8, 0x00005AD7, 0x000079C6, 0x000098B5, 0x0000B7A4, 0x0000D693,
+    0x0000F582, 0x00001471, 0x00003360, 0x0000524F, 0x0000713E, 0x0000902D, 0x0000AF1C, 0x0000CE0B, 0x0000ECFA, 0x0000BE9,
+    0x00002AD8, 0x000049C7, 0x000068B6, 0x000087A5, 0x0000A694, 0x0000C583, 0x0000E472, 0x0000361, 0x00002250, 0x0000413F,
+    0x0000602E, 0x00007F1D, 0x00009E0C, 0x0000BCFB, 0x0000DBEA, 0x0000FAD9, 0x000019C8, 0x000038B7, 0x000057A6, 0x00007695,
+    0x00009584, 0x0000B473, 0x0000D362, 0x0000F251, 0x00001140, 0x0000302F, 0x00004F1E, 0x00006E0D, 0x00008CFC, 0x0000ABEB,
+    0x0000CADA, 0x0000E9C9, 0x00008B8, 0x000027A7, 0x00004696, 0x00006585, 0x00008474, 0x0000A363, 0x0000C252, 0x0000E141,
+    0x000030, 0x00001F1F, 0x00003E0E, 0x00005CFD, 0x00007BEC, 0x00009ADB, 0x0000B9CA, 0x0000D8B9, 0x0000F7A8, 0x00001697,
+    0x00003586, 0x00005475, 0x00007364, 0x00009253, 0x0000B142, 0x0000D031, 0x0000EF20, 0x0000E0F, 0x00002CFE, 0x00004BED,
+    0x00006ADC, 0x000089CB, 0x0000A8BA, 0x0000C7A9, 0x0000E698, 0x0000587, 0x00002476, 0x00004365, 0x00006254, 0x00008143,
+    0x0000A032, 0x0000BF21, 0x0000DE10, 0x0000FCFF, 0x00001BEE, 0x00003ADD, 0x000059CC, 0x000078BB, 0x000097AA, 0x0000B699,
+    0x0000D588, 0x0000F477, 0x00001366, 0x00003255, 0x00005144, 0x00007033, 0x00008F22, 0x0000AE11, 0x0000CD00, 0x0000EBEF,
+    0x0000ADE, 0x000029CD, 0x000048BC, 0x000067AB, 0x0000869A, 0x0000A589, 0x0000C478, 0x0000E367, 0x0000256, 0x00002145,
+    0x00004034, 0x00005F23, 0x00007E12, 0x00009D01, 0x0000BBF0, 0x0000DADF, 0x0000F9CE, 0x000018BD, 0x000037AC, 0x0000569B,
+    0x0000758A, 0x00009479, 0x0000B368, 0x0000D257, 0x0000F146, 0x00001035, 0x00002F24, 0x00004E13, 0x00006D02, 0x00008BF1,
+    0x0000AAE0, 0x0000C9CF, 0x0000E8BE, 0x00007AD, 0x0000269C, 0x0000458B, 0x0000647A, 0x00008369, 0x0000A258, 0x0000C147,
+    0x0000E036, 0x0000FF25, 0x00001E14, 0x00003D03, 0x00005BF2, 0x00007AE1, 0x000099D0, 0x0000B8BF, 0x0000D7AE, 0x0000F69D,
+    0x0000158C, 0x0000347B, 0x0000536A, 0x00007259, 0x00009148, 0x0000B037, 0x0000CF26, 0x0000EE15, 0x0000D04, 0x00002BF3,
+    0x00004AE2, 0x000069D1, 0x000088C0, 0x0000A7AF, 0x0000C69E, 0x0000E58D, 0x000047C, 0x0000236B, 0x0000425A, 0x00006149,
+    0x00008038, 0x00009F27, 0x0000BE16, 0x0000DD05, 0x0000FBF4, 0x00001AE3, 0x000039D2, 0x000058C1, 0x000077B0, 0x0000969F,
+    0x0000B58E, 0x0000D47D, 0x0000F36C, 0x0000125B, 0x0000314A, 0x00005039, 0x00006F28, 0x00008E17, 0x0000AD06, 0x0000CBF5,
+    0x0000EAE4, 0x00009D3, 0x000028C2, 0x000047B1, 0x000066A0, 0x0000858F, 0x0000A47E, 0x0000C36D, 0x0000E25C, 0x000014B,
+    0x0000203A, 0x00003F29, 0x00005E18, 0x00007D07, 0x00009BF6, 0x0000BAE5, 0x0000D9D4, 0x0000F8C3, 0x000017B2, 0x000036A1,
+    0x00005590, 0x0000747F, 0x0000936E, 0x0000B25D, 0x0000D14C, 0x0000F03B, 0x0000F2A, 0x00002E19, 0x00004D08, 0x00006BF7,
+    0x00008AE6, 0x0000A9D5, 0x0000C8C4, 0x0000E7B3, 0x00006A2, 0x00002591, 0x00004480, 0x0000636F, 0x0000825E, 0x0000A14D,
+};
+
+static unsigned long checksum(const unsigned char *data, int size) {
+    unsigned long h = 0;
+    int i;
+    for (i = 0; i < size; i++) h = (h * 31 + data[i]) % 1000003;
+    return h;
+}
+
+int main() {
+    int result = 0;
+    int i;
+    unsigned long sum = 0;
+
+    printf("Test 1: %lu\n", checksum(exact, sizeof(exact)));
+    if (sizeof(exact) != 1000 || checksum(exact, sizeof(exact)) != 279703UL) result = 1;
+
+    printf("Test 2: %lu\n", checksum((const unsigned char *)padded, sizeof(padded)));
+    if (sizeof(padded) != 703
+            || checksum((const unsigned char *)padded, sizeof(padded)) != 661137UL) result = 1;
+
+    for (i = 0; i < (int)(sizeof(numbers) / sizeof(numbers[0])); i++) sum += numbers[i];
+    printf("Test 3: %lu\n", sum);
+    if (sizeof(numbers) / sizeof(numbers[0]) != 900 || sum != 29329754UL) result = 1;
+
+    return result;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <string.h>
+#include "stringize.h"
+
+// Edge case: Function-like macros defined in a header
+// Their names are lowercase and the file never defines them, so literal
+// arguments must be passed on as written: the macro may stringize them
+
+static int twice(int v) { return v * 2; }
+
+int main() {
+    int result = 0;
+
+    // Test 1: Numbers stringized by a header macro
+    printf("Test 1: %s %s\n", str(0x10), str(1.50));
+    if (strcmp(str(0x10), "0x10") != 0 || strcmp(str(1.50), "1.50") != 0) result = 1;
+
+    // Test 2: A string and a char stringized with their escapes
+    printf("Test 2: %s %s\n", str("\x41"), str('\101'));
+    if (strcmp(str("\x41"), "\"\\x41\"") != 0 || strcmp(str('\101'), "'\\101'") != 0) result = 1;
+
+    // Test 3: A constant expression stringized, not folded
+    printf("Test 3: %s\n", str(2+3));
+    if (strcmp(str(2+3), "2+3") != 0) result = 1;
+
+    // Test 4: Numbers pasted into one: 00 must not become 0
+    printf("Test 4: %d\n", paste(1, 00));
+    if (paste(1, 00) != 100) result = 1;
+
+    // Test 5: Calls of functions the file declares are still compacted
+    printf("Test 5: %d\n", twice(0x0000000A));
+    if (twice(0x0000000A) != 20) result = 1;
+
+    return result;
+}
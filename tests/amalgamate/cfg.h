@@ -0,0 +1,11 @@
+/* Shared configuration, included by both files */
+#ifndef CFG_H
+#define CFG_H
+
+#define BUFSZ 32
+#define LONG_MACRO(x) \
+    ((x) + BUFSZ)
+
+static inline int twice(int v) { return v * 2; }
+
+#endif
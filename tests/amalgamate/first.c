@@ -0,0 +1,16 @@
+#include "cfg.h"
+
+// Edge case: Amalgamation, first file
+// Redefines a header macro, and declares statics whose names the second
+// file also uses: a variable of the same name, a variable named like the
+// second file's static function, and a byte-identical static function
+
+#undef BUFSZ
+#define BUFSZ 64
+
+static int count = 3;
+static int scale = 5;
+
+static int square(int v) { return v * v; }
+
+int first_value(void) { return BUFSZ + square(count) + scale + LONG_MACRO(0); }
@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include "cfg.h"
+
+// Edge case: Amalgamation, second file
+// Must still see the header's BUFSZ, its own statics and the first file's
+// function, once both files are one translation unit
+
+static int count = 4;
+
+static int scale(int v) { return v * 10; }
+
+static int square(int v) { return v * v; }
+
+int first_value(void);
+
+int main() {
+    int result = 0;
+
+    // Test 1: The header's macro, not the first file's redefinition
+    printf("Test 1: %d\n", BUFSZ);
+    if (BUFSZ != 32) result = 1;
+
+    // Test 2: The first file's statics
+    printf("Test 2: %d\n", first_value());
+    if (first_value() != 64 + 9 + 5 + 64) result = 1;
+
+    // Test 3: This file's statics and the header's inline function
+    printf("Test 3: %d %d\n", scale(square(count)), twice(count));
+    if (scale(square(count)) != 160 || twice(count) != 8) result = 1;
+
+    return result;
+}
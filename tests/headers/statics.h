@@ -0,0 +1,18 @@
+/* Definitions a header provides to every file including it; the header
+ * itself references none of them */
+#ifndef STATICS_H
+#define STATICS_H
+
+static const int table_size = 4;
+static int lookup_table[4] = {1, 2, 4, 8};
+
+static inline int clamp_index(int index) {
+    int unused_local = 0;
+    return index < 0 ? 0 : index >= table_size ? table_size - 1 : index;
+}
+
+static int lookup(int index) {
+    return lookup_table[clamp_index(index)];
+}
+
+#endif
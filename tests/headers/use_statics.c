@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include "statics.h"
+
+// Edge case: Dead code removal run on a header as well as its includer
+// The header's statics are unreferenced inside it, but are its interface
+
+static int unused_helper(void) { return 42; }
+
+int main() {
+    int result = 0;
+
+    // Test 1: A static inline function and a static array from the header
+    printf("Test 1: %d %d\n", lookup(2), lookup(9));
+    if (lookup(2) != 4 || lookup(9) != 8) result = 1;
+
+    // Test 2: A static constant from the header
+    printf("Test 2: %d\n", table_size);
+    if (table_size != 4) result = 1;
+
+    return result;
+}
@@ -0,0 +1,9 @@
+/* Lowercase function-like macros, as a header would define them */
+#ifndef STRINGIZE_H
+#define STRINGIZE_H
+
+#define str(x) #x
+#define xstr(x) str(x)
+#define paste(a, b) a##b
+
+#endif
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""
+Amalgamation of several files into one translation unit
+
+Amalgamates tests/amalgamate/, whose two files share a guarded header,
+redefine one of its macros, declare clashing statics and an identical
+static function, then compiles and runs the single output. The header's
+macro must be back for the second file, the clashing statics renamed
+apart and the identical function collapsed.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(TEST_DIR, '..'))
+
+import amalgamate
+
+SOURCES = os.path.join(TEST_DIR, 'amalgamate')
+FILES = ('first.c', 'second.c')
+
+
+def main():
+    report = {}
+    output = amalgamate.amalgamate([os.path.join(SOURCES, f) for f in FILES], report=report)
+    if report['functions_collapsed'] < 1:
+        print("identical static function not collapsed")
+        return 1
+    if report['statics_renamed'] < 1:
+        print("clashing statics not renamed apart")
+        return 1
+    with tempfile.TemporaryDirectory() as out:
+        unity = os.path.join(out, 'unity.c')
+        with open(unity, 'wb') as f:
+            f.write(output + b'\n')
+        binary = os.path.join(out, 'unity')
+        compiled = subprocess.run(['gcc', '-o', binary, unity],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        if compiled.returncode != 0:
+            print(f"amalgamated output does not compile:\n{compiled.stderr}")
+            return 1
+        if subprocess.run([binary], stdout=subprocess.DEVNULL).returncode != 0:
+            print("amalgamated program gives wrong results")
+            return 1
+    print(f"{report['files']} files amalgamated into one compiling translation unit")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""
+Dead code removal on headers in directory mode
+
+Minifies tests/headers/ with --remove-dead-code the way batch mode does,
+headers included, then compiles and runs the minified .c file against the
+minified header. The header's statics are referenced only by its
+includers, so they must survive; the includer's own unused static must
+still go.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(TEST_DIR, '..'))
+
+import batch
+
+SOURCES = os.path.join(TEST_DIR, 'headers')
+
+
+def main():
+    with tempfile.TemporaryDirectory() as out:
+        results = batch.run_batch([SOURCES], out, jobs=1, passes={'remove_dead_code': True})
+        for source, _, _, _, error, _, _ in results:
+            if error:
+                print(f"{source}: {error}")
+                return 1
+        with open(os.path.join(out, 'use_statics.c'), 'rb') as f:
+            if b'unused_helper' in f.read():
+                print("use_statics.c: unused static function kept")
+                return 1
+        binary = os.path.join(out, 'use_statics')
+        compiled = subprocess.run(['gcc', '-o', binary, os.path.join(out, 'use_statics.c')],
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+        if compiled.returncode != 0:
+            print(f"minified header does not compile:\n{compiled.stderr}")
+            return 1
+        if subprocess.run([binary], stdout=subprocess.DEVNULL).returncode != 0:
+            print("minified program gives wrong results")
+            return 1
+    print(f"{len(results)} files minified with their header statics intact")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Incremental re-minification against full re-minification
+
+Edits every fixture in this directory with a seeded series of renames,
+insertions, deletions and multi-edit updates, and after each one compares
+IncrementalMinifier's output with CMinifier(new source).minify(). An
+update with an out-of-range edit must be refused without changing state.
+"""
+
+import os
+import random
+import re
+import sys
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(TEST_DIR, '..'))
+
+import minify
+from incremental import IncrementalMinifier, TextEdit
+
+STEPS = 30
+IDENTIFIER = re.compile(rb'\b[A-Za-z_]\w*\b')
+DECLARATIONS = [
+    b'static int inserted_count = 0;\n',
+    b'static int inserted_helper(int v) { int w = v + 1; return w * inserted_count; }\n',
+    b'int inserted_public;\n',
+]
+
+
+def identifiers(source):
+    """(start, end) of identifier-like words outside directives and strings, roughly"""
+    spans = []
+    for line in re.finditer(rb'[^\n]*\n?', source):
+        text = line.group()
+        if text.lstrip().startswith(b'#') or b'"' in text or b"'" in text:
+            continue
+        for word in IDENTIFIER.finditer(text):
+            if word.group() not in minify.KEYWORDS:
+                spans.append((line.start() + word.start(), line.start() + word.end()))
+    return spans
+
+
+def random_edits(rng, source):
+    """One update's TextEdits, offsets relative to the previous edit as editors report them"""
+    edits = []
+    for _ in range(rng.randint(1, 3)):
+        r = rng.random()
+        spans = identifiers(source)
+        if r < 0.5 and spans:
+            # Rename one occurrence to another name of the file, or a new one
+            start, end = rng.choice(spans)
+            other = rng.choice(spans)
+            name = source[other[0]:other[1]] if rng.random() < 0.7 else b'renamed_x'
+            edit = TextEdit(start, end, name)
+        elif r < 0.8:
+            # A new top-level declaration at the start or the end
+            at = 0 if rng.random() < 0.5 else len(source)
+            edit = TextEdit(at, at, rng.choice(DECLARATIONS))
+        else:
+            # Delete a line
+            lines = [m.span() for m in re.finditer(rb'[^\n]*\n', source)]
+            if not lines:
+                continue
+            start, end = rng.choice(lines)
+            edit = TextEdit(start, end, b'')
+        source = source[:edit.start_byte] + edit.new_text + source[edit.old_end_byte:]
+        edits.append(edit)
+    return edits, source
+
+
+def check_file(path, rng):
+    """None if every update of path matches a full re-minify, else a description"""
+    original = bytes(minify.read_source(path))
+    session = IncrementalMinifier(original)
+    if session.minify() != minify.CMinifier(original).minify():
+        return "initial output differs"
+    source = original
+    for step in range(STEPS):
+        if step == STEPS // 2:
+            # A whole new text, diffed into one edit
+            source = original
+            output = session.set_source(source)
+        else:
+            edits, source = random_edits(rng, source)
+            output = session.update(edits)
+        if output != minify.CMinifier(source).minify():
+            return f"step {step}: output differs from a full re-minify"
+
+    before = session.minify()
+    try:
+        session.update([TextEdit(0, 0, b'int refused;\n'),
+                        TextEdit(len(source) + 100, len(source) + 100, b'')])
+    except ValueError:
+        pass
+    else:
+        return "out-of-range edit accepted"
+    if session.minify() != before or session.source_bytes != source:
+        return "refused update changed the session"
+    output = session.update([TextEdit(0, 0, DECLARATIONS[0])])
+    if output != minify.CMinifier(DECLARATIONS[0] + source).minify():
+        return "update after a refused one differs from a full re-minify"
+    return None
+
+
+def main():
+    rng = random.Random(1)
+    files = sorted(f for f in os.listdir(TEST_DIR) if f.endswith('.c') and not f.endswith('_min.c'))
+    for f in files:
+        problem = check_file(os.path.join(TEST_DIR, f), rng)
+        if problem:
+            print(f"{f}: {problem}")
+            return 1
+    print(f"{len(files)} files, {STEPS} updates each, match a full re-minify")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
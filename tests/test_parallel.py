@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Parallel minification against sequential minification
+
+Minifies every fixture in this directory and a generated many-function
+file with parallel.minify_parallel() on a small pool and compares the
+output byte for byte with CMinifier(source).minify(), with renaming on
+and off. The generated file must take the parallel path, also with some
+functions inside #if blocks, which chunks must not cut; a copy wrapped in
+one #if has no place to cut, so it must fall back, say why and still match.
+"""
+
+import os
+import sys
+from concurrent.futures import ProcessPoolExecutor
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(TEST_DIR, '..'))
+
+import minify
+import parallel
+
+JOBS = 3
+FUNCTIONS = 300
+
+
+def generated_source(conditional=False):
+    """Many functions sharing statics, macros and names across chunk boundaries
+
+    With conditional, every third function sits in an #ifdef block.
+    """
+    parts = [b'#include <stdio.h>\n#define SCALE(x, y) ((x) * (y) + OFFSET)\n#define OFFSET 3\n']
+    for i in range(FUNCTIONS):
+        parts.append(b'static int table_%d[] = { %d, %d, %d };\n' % (i, i, i + 1, i + 2))
+        parts.append(b'static int counter_%d = %d;\n' % (i % 7, i))
+        if conditional and i % 3 == 0:
+            parts.append(b'#ifndef SKIP_%d\n' % i)
+        parts.append(
+            b'/* function %d */\n'
+            b'int function_%d(int value, const char *label)\n'
+            b'{\n'
+            b'    int total = counter_%d;\n'
+            b'    for (int index = 0; index < 3; index++) {\n'
+            b'        int scaled = SCALE(table_%d[index], value);\n'
+            b'        total += scaled;\n'
+            b'    }\n'
+            b'    if (label) printf("%%s %%d\\n", label, total);\n'
+            b'    return total + function_%d(value - 1, 0);\n'
+            b'}\n\n' % (i, i, i % 7, i, max(i - 1, 0)))
+        if conditional and i % 3 == 0:
+            parts.append(b'#endif\n')
+    parts.append(b'int main(void) { return function_%d(2, "done") & 1; }\n' % (FUNCTIONS - 1))
+    return b''.join(parts)
+
+
+def main():
+    parallel.MIN_PARALLEL_BYTES = 0
+    sequential_calls = []
+    minify_sequential = parallel.minify_sequential
+
+    def counted(source, enable_renaming):
+        sequential_calls.append(len(source))
+        return minify_sequential(source, enable_renaming)
+    parallel.minify_sequential = counted
+
+    files = sorted(f for f in os.listdir(TEST_DIR) if f.endswith('.c') and not f.endswith('_min.c'))
+    sources = [(f, bytes(minify.read_source(os.path.join(TEST_DIR, f)))) for f in files]
+    generated = generated_source()
+    # An #if around everything: no line outside a conditional to cut at
+    unsplittable = b'#if 1\n' + generated + b'#endif\n'
+    sources += [('generated', generated), ('conditional', generated_source(conditional=True)),
+                ('unsplittable', unsplittable)]
+
+    with ProcessPoolExecutor(max_workers=JOBS, initializer=parallel.init_worker) as pool:
+        for name, source in sources:
+            for enable_renaming in (True, False):
+                del sequential_calls[:]
+                expected = minify.CMinifier(source, enable_renaming=enable_renaming).minify()
+                report = {}
+                output = parallel.minify_parallel(source, JOBS, enable_renaming, pool, report)
+                if output != expected:
+                    print(f"{name} (renaming {'on' if enable_renaming else 'off'}): "
+                          f"output differs from sequential")
+                    return 1
+                if name in ('generated', 'conditional') and sequential_calls:
+                    print(f"{name}: fell back to the sequential path ({report['fallback']})")
+                    return 1
+                if name == 'unsplittable' and not (sequential_calls and report['fallback']):
+                    print("unsplittable: fallback to the sequential path not reported")
+                    return 1
+    print(f"{len(sources)} files minified in parallel byte-identically")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
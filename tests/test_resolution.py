@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+Randomized check of local renaming
+
+Feeds random identifier event streams to resolve_identifiers() and resolves
+every reference twice, C-style: once by original names and once by the
+names written to the output. Renaming is correct when each reference finds
+the same declaration both ways and no renamed declaration collides with
+another one in its scope.
+"""
+
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+import minify
+from minify import EV_ENTER, EV_EXIT, EV_DECL_STATIC, EV_DECL_LOCAL, EV_DECL_KEEP, EV_USE
+
+NAMES = [b'x', b'y', b'z', b'i', b'n', b'a', b'b', b'printf', b'g']
+STREAMS = 20000
+
+
+def random_events(rng):
+    """Events of one to four functions, each preceded by a few file-scope events"""
+    events = []
+    offset = 0
+
+    def token(kind, name):
+        nonlocal offset
+        offset += 10
+        events.append((kind, offset, offset + len(name), name))
+
+    for _ in range(rng.randint(1, 4)):
+        if rng.random() < 0.3:
+            token(EV_DECL_STATIC, rng.choice(NAMES))
+        if rng.random() < 0.3:
+            token(EV_USE, rng.choice(NAMES))
+        events.append((EV_ENTER,))
+        depth = 1
+        for _ in range(rng.randint(1, 40)):
+            r = rng.random()
+            if r < 0.1:
+                events.append((EV_ENTER,))
+                depth += 1
+            elif r < 0.2 and depth > 1:
+                events.append((EV_EXIT,))
+                depth -= 1
+            elif r < 0.45:
+                # Often the same name twice in one scope, as #ifdef/#else arms declare it
+                token(EV_DECL_LOCAL, rng.choice(NAMES))
+            elif r < 0.5:
+                token(EV_DECL_KEEP, rng.choice(NAMES))
+            else:
+                token(EV_USE, rng.choice(NAMES))
+        events.extend([(EV_EXIT,)] * depth)
+    return events
+
+
+def resolve(events, spelling):
+    """Declaration start each reference resolves to, and the same-scope redeclarations
+
+    spelling(start, name) is the name written at start. A redeclaration is
+    the pair (original names) of a declaration and the one it hides in the
+    same scope.
+    """
+    scopes = [{}]
+    found = {}
+    redeclared = set()
+    for event in events:
+        kind = event[0]
+        if kind == EV_ENTER:
+            scopes.append({})
+        elif kind == EV_EXIT:
+            scopes.pop()
+        else:
+            _, start, _, name = event
+            spelled = spelling(start, name)
+            if kind == EV_USE:
+                for scope in reversed(scopes):
+                    if spelled in scope:
+                        found[start] = scope[spelled][0]
+                        break
+                else:
+                    found[start] = spelled
+            else:
+                scope = scopes[0 if kind == EV_DECL_STATIC else -1]
+                if spelled in scope:
+                    redeclared.add((scope[spelled][1], name))
+                scope[spelled] = (start, name)
+                found[start] = start
+    return found, redeclared
+
+
+def check(events):
+    """None if the renames of events are correct, else a description"""
+    minifier = minify.CMinifier(b'')
+    reserved = minify.KEYWORDS | {b'g', b'printf'}
+    reserved |= {event[3] for event in events if event[0] == EV_DECL_KEEP}
+    minifier.resolve_identifiers(events, reserved)
+    starts = list(minifier.replacements.starts)
+    if starts != sorted(set(starts)):
+        return 'renames out of source order'
+    renamed = {start: new_name for start, _, new_name in minifier.replacements}
+    before, before_redeclared = resolve(events, lambda start, name: name)
+    after, after_redeclared = resolve(events, lambda start, name: renamed.get(start, name))
+    statics = {event[1] for event in events if event[0] == EV_DECL_STATIC}
+    for start, target in before.items():
+        # A name used before its static declaration may find it once
+        # both are renamed, which C would too had it been declared first
+        if after[start] != target and not (isinstance(target, bytes) and after[start] in statics):
+            return f"reference at {start} resolves to {after[start]}, not {target}"
+    for first, second in after_redeclared - before_redeclared:
+        if first != second:
+            return f"{first.decode()} and {second.decode()} renamed alike in one scope"
+    return None
+
+
+def main():
+    rng = random.Random(1)
+    for i in range(STREAMS):
+        events = random_events(rng)
+        problem = check(events)
+        if problem:
+            print(f"stream {i}: {problem}")
+            return 1
+    print(f"{STREAMS} random streams renamed correctly")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,751 @@
+#!/usr/bin/env python3
+"""
+Structural verification of minified output
+
+Compiling and running minified files needs a main() and a compiler, and is
+far too slow to repeat for every file of a batch. This checks the output
+against its source instead, without taking the minifier's word for any
+rename or rewrite:
+1. The output is reparsed with tree-sitter; a syntax error the source did
+   not have is a divergence
+2. Both trees are read as streams of significant tokens: leaves, literals
+   whole, comments and whitespace left out. Tokens must agree in node type
+   and text, except:
+   - identifiers, which may be spelled differently as long as the renaming
+     is consistent: every source binding, resolved by scope from the
+     walk's declarations and uses, is written under one name, and bindings
+     visible together under distinct ones
+   - number, string and char literals, which are compared by value (and
+     integer type), not by spelling
+   - integer constant expressions, adjacent string literals and literal
+     lists of char arrays, which may be written as the one literal of the
+     same value
+   - '#if 0' branches and what follows an '#if 1', which may be left out
+   Only subtrees dropped as dead code are taken as the minifier recorded
+   them
+3. Macro bodies are compared as preprocessing tokens, lexed by maximal
+   munch, so two tokens written together where they merge show up;
+   parameters of function-like macros may be renamed within their macro
+The first divergence is reported with its line and column in both files.
+The cost is one parse of the output and one pass over each tree.
+
+Usage: python3 verify.py [--remove-dead-code] [--compact-literals] <file.c>...
+"""
+
+import re
+import sys
+from fractions import Fraction
+
+import minify
+
+# Preprocessing tokens of a run of bytes without whitespace: pp-numbers,
+# identifiers, then punctuators longest first
+PP_LEXEME = re.compile(rb'\.?[0-9](?:[eEpP][+-]|[A-Za-z0-9_.])*|[A-Za-z_\x80-\xff][A-Za-z0-9_\x80-\xff]*'
+                       rb'|\.\.\.|<<=|>>=|%:%:|->|\+\+|--|<<|>>|&&|\|\||[-+*/%&|^!=<>]=|##'
+                       rb'|<:|:>|<%|%>|%:|.', re.S)
+IDENTIFIER = re.compile(rb'[A-Za-z_\x80-\xff][A-Za-z0-9_\x80-\xff]*')
+INTEGER_LITERAL = re.compile(rb'(0[xX][0-9a-fA-F]+|0[bB][01]+|0[0-7]*|[1-9][0-9]*)([uUlL]*)')
+DECIMAL_FLOATING = re.compile(rb'([0-9]*)(?:\.([0-9]*))?(?:[eE]([+-]?[0-9]+))?([fFlL]?)')
+HEX_FLOATING = re.compile(rb'0[xX]([0-9a-fA-F]*)(?:\.([0-9a-fA-F]*))?[pP]([+-]?[0-9]+)([fFlL]?)')
+STRING_PREFIX = re.compile(rb'(u8|[LuU]?)["\']')
+SIMPLE_ESCAPE_VALUES = {ord(c): v for c, v in zip('\'"?\\abfnrtv', b'\'"?\\\a\b\f\n\r\t\v')}
+INT_MAX = (1 << 31) - 1
+# Types a char array may be initialized from a string as
+CHAR_TYPES = {b'char', b'signed char', b'unsigned char'}
+# Expression nodes an integer constant may have been folded from
+EXPRESSION_TYPES = {'binary_expression', 'unary_expression', 'parenthesized_expression'}
+# The opening directive an '#elif' becomes once the branches before it are gone
+OPENING_DIRECTIVES = {'#elif': '#if', '#elifdef': '#ifdef', '#elifndef': '#ifndef'}
+# Longest token text quoted in a report
+QUOTE_BYTES = 40
+
+
+class Divergence(Exception):
+    """The output stops matching its source: reason, source offset, and the expected text"""
+
+
+def macro_tokens(text):
+    """Preprocessing tokens of a macro body, continuations joined and comments dropped"""
+    if b'\\' in text:
+        text = minify.LINE_SPLICE.sub(b'', text)
+    tokens = []
+    run = []  # adjacent pieces: lexed together, as they may merge
+    for piece in minify.MACRO_PIECE.findall(text):
+        if piece.isspace() or piece[:2] in (b'/*', b'//'):
+            literal = None
+        elif piece[:1] in (b'"', b"'") and len(piece) > 1 and piece[-1:] == piece[:1]:
+            literal = piece
+        else:
+            run.append(piece)
+            continue
+        tokens.extend(PP_LEXEME.findall(b''.join(run)))
+        run = []
+        if literal is not None:
+            tokens.append(literal)
+    tokens.extend(PP_LEXEME.findall(b''.join(run)))
+    return tokens
+
+
+def number_value(text):
+    """(value, type key) of a number literal, or None if it is not one we read
+
+    The type key tells literals of equal value apart when the type they
+    take may differ: the suffix, and for a large unsuffixed or 'l' integer
+    whether it is decimal, which C types by a different list than hex.
+    """
+    match = INTEGER_LITERAL.fullmatch(text)
+    if match:
+        digits, suffix = match.groups()
+        base = 16 if digits[:2] in (b'0x', b'0X') else 2 if digits[:2] in (b'0b', b'0B') \
+            else 8 if digits[:1] == b'0' and len(digits) > 1 else 10
+        value = int(digits[2:] if base in (16, 2) else digits, base)
+        suffix = suffix.lower()
+        unsigned = b'u' in suffix
+        longs = suffix.count(b'l')
+        limit = (1 << 63) - 1 if longs == 2 else INT_MAX
+        decimal = base == 10 if value > limit and not unsigned else None
+        return value, ('int', unsigned, longs, decimal)
+    match = DECIMAL_FLOATING.fullmatch(text)
+    if match and (match.group(2) is not None or match.group(3) is not None):
+        whole, fraction, exponent, suffix = match.groups()
+        fraction = fraction or b''
+        value = Fraction(int(whole + fraction or b'0'), 10 ** len(fraction))
+        value *= Fraction(10) ** int(exponent or b'0')
+        return value, ('float', suffix.lower())
+    match = HEX_FLOATING.fullmatch(text)
+    if match:
+        whole, fraction, exponent, suffix = match.groups()
+        fraction = fraction or b''
+        value = Fraction(int(whole + fraction or b'0', 16), 16 ** len(fraction))
+        value *= Fraction(2) ** int(exponent)
+        return value, ('float', suffix.lower())
+    return None
+
+
+def literal_value(text):
+    """(prefix, code units) of a string or char literal with its escapes
+    decoded as C does, or None
+
+    Raw non-ASCII bytes and escapes without a value of their own (UCNs,
+    \\e) are kept as text.
+    """
+    match = STRING_PREFIX.match(text)
+    if not match:
+        return None
+    if b'\\' in text:
+        text = minify.LINE_SPLICE.sub(b'', text)
+    quote = text[match.end() - 1]
+    if len(text) < match.end() + 1 or text[-1] != quote:
+        return None
+    units = []
+    i, end = match.end(), len(text) - 1
+    while i < end:
+        c = text[i]
+        if c != 0x5c:
+            units.append(c if c < 0x80 else bytes((c,)))
+            i += 1
+            continue
+        n = text[i + 1]
+        if n in SIMPLE_ESCAPE_VALUES:
+            units.append(SIMPLE_ESCAPE_VALUES[n])
+            i += 2
+        elif 0x30 <= n <= 0x37:
+            j = i + 1
+            while j < end and j < i + 4 and 0x30 <= text[j] <= 0x37:
+                j += 1
+            units.append(int(text[i + 1:j], 8))
+            i = j
+        elif n == 0x78:  # \x takes every hex digit that follows
+            j = i + 2
+            while j < end and chr(text[j]) in '0123456789abcdefABCDEF':
+                j += 1
+            units.append(int(text[i + 2:j] or b'0', 16))
+            i = j
+        elif n in b'uU':
+            j = i + (6 if n == 0x75 else 10)
+            units.append(text[i:j])
+            i = j
+        else:
+            units.append(text[i:i + 2])
+            i += 2
+    return match.group(1), units
+
+
+def same_literal(node_type, text, found_text):
+    """True if two spellings of a literal token have the same value and type"""
+    if node_type == 'number_literal':
+        value = number_value(text)
+        return value is not None and value == number_value(found_text)
+    if node_type in ('string_literal', 'char_literal'):
+        value = literal_value(text)
+        return value is not None and value == literal_value(found_text)
+    return False
+
+
+def binary_value(operator, left, right):
+    """C semantics of a binary operator on two ints, None where they are undefined"""
+    if operator in ('/', '%'):
+        if right == 0:
+            return None
+        quotient = abs(left) // abs(right)
+        if (left < 0) != (right < 0):
+            quotient = -quotient  # C truncates toward zero
+        return quotient if operator == '/' else left - right * quotient
+    if operator in ('<<', '>>'):
+        if left < 0 or not 0 <= right < 31:
+            return None
+        return left << right if operator == '<<' else left >> right
+    operations = {'+': int.__add__, '-': int.__sub__, '*': int.__mul__, '&': int.__and__,
+                  '|': int.__or__, '^': int.__xor__,
+                  '&&': lambda a, b: int(bool(a and b)), '||': lambda a, b: int(bool(a or b)),
+                  '<': lambda a, b: int(a < b), '>': lambda a, b: int(a > b),
+                  '<=': lambda a, b: int(a <= b), '>=': lambda a, b: int(a >= b),
+                  '==': lambda a, b: int(a == b), '!=': lambda a, b: int(a != b)}
+    operation = operations.get(operator)
+    return None if operation is None else operation(left, right)
+
+
+class SourceTokens:
+    """Significant tokens of the source, as the output must match them
+
+    items() yields (node_type, text, start, extra): extra is the binding
+    key of an identifier, the parameter keys of a function-like macro's
+    body, and None otherwise. node_type None marks a group, a subtree the
+    output may also write as one literal of the same value; extra is then
+    its node.
+    """
+    def __init__(self, minifier):
+        self.source_bytes = minifier.source_bytes
+        self.tree = minifier.tree
+        self.skip = minifier.skip or ()
+        self.keys = binding_keys(minifier.events)
+        self.values = {}  # (start, end) -> constant value of an expression, or None
+
+    def text(self, node):
+        return bytes(self.source_bytes[node.start_byte:node.end_byte])
+
+    def items(self, node=None):
+        cursor = (node or self.tree.root_node).walk()
+        skip = self.skip
+        while True:
+            node = cursor.node
+            node_type = node.type
+            start, end = node.start_byte, node.end_byte
+            if (start, end) in skip or node_type == 'comment':
+                pass
+            elif node_type == 'preproc_if' and self.live_branches(node) is not None:
+                yield from self.conditional(node)
+            elif self.is_group(node):
+                yield None, None, start, node
+            elif node_type not in minify.ATOMIC_TYPES and cursor.goto_first_child():
+                continue
+            elif start != end:
+                text = self.text(node)
+                if not text.isspace():
+                    extra = None
+                    if node_type == 'identifier':
+                        parent = node.parent
+                        if parent is not None and parent.type == 'preproc_params':
+                            extra = ('parameter', parent.start_byte, text)
+                        else:
+                            extra = self.keys.get(start)
+                    elif node_type == 'preproc_arg' and node.parent.type == 'preproc_function_def':
+                        params = node.parent.child_by_field_name('parameters')
+                        extra = {self.text(param): ('parameter', params.start_byte, self.text(param))
+                                 for param in params.children if param.type == 'identifier'}
+                    yield node_type, text, start, extra
+            while not cursor.goto_next_sibling():
+                if not cursor.goto_parent():
+                    return
+
+    def live_branches(self, node):
+        """[(branch, always taken)] of an #if chain that may still be taken, or
+        None when no '#if'/'#elif' condition is the literal 0 or 1"""
+        branches = []
+        constant = False
+        branch = node
+        while branch is not None:
+            if branch.type == 'preproc_else':
+                branches.append((branch, True))
+                break
+            condition = branch.child_by_field_name('condition')
+            text = self.text(condition) if condition is not None else None
+            if condition is not None and condition.type == 'number_literal' and text in (b'0', b'1'):
+                constant = True
+                if text == b'1':
+                    branches.append((branch, True))
+                    break
+            else:
+                branches.append((branch, False))
+            branch = branch.child_by_field_name('alternative')
+        return branches if constant else None
+
+    def conditional(self, node):
+        """Items of an #if chain without the branches that cannot be taken"""
+        opened = False
+        for branch, always in self.live_branches(node):
+            directive = branch.children[0]
+            condition = branch.child_by_field_name('condition')
+            alternative = branch.child_by_field_name('alternative')
+            if always and opened:
+                yield '#else', b'#else', directive.start_byte, None
+            elif not always:
+                # The first branch left opens the chain
+                opening = directive.type if opened else OPENING_DIRECTIVES.get(directive.type,
+                                                                               directive.type)
+                text = self.text(directive) if opening == directive.type else opening.encode('ascii')
+                yield opening, text, directive.start_byte, None
+                condition = None  # written too
+            for child in branch.children[1:]:
+                if child == alternative:
+                    break
+                if child != condition and child.type != '#endif':
+                    yield from self.items(child)
+            if always:
+                break
+            opened = True
+        if opened:
+            yield from self.items(node.children[-1])  # its #endif
+
+    def is_group(self, node):
+        node_type = node.type
+        if node_type in EXPRESSION_TYPES:
+            value = self.constant(node)
+            return value is not None and value >= 0
+        if node_type == 'concatenated_string':
+            return all(child.type in ('string_literal', 'comment') for child in node.children)
+        if node_type == 'initializer_list':
+            return self.char_array(node) is not None
+        return False
+
+    def constant(self, node):
+        """Value of an integer constant expression of int literals, or None"""
+        key = (node.start_byte, node.end_byte)
+        if key in self.values:
+            return self.values[key]
+        value = None
+        node_type = node.type
+        operands = [child for child in node.named_children if child.type != 'comment']
+        if node_type == 'number_literal':
+            number = number_value(self.text(node))
+            if number is not None and number[1] == ('int', False, 0, None) and number[0] <= INT_MAX:
+                value = number[0]
+        elif node_type == 'parenthesized_expression' and len(operands) == 1:
+            value = self.constant(operands[0])
+        elif node_type == 'unary_expression':
+            argument = self.constant(node.child_by_field_name('argument'))
+            operator = node.child_by_field_name('operator').type
+            if argument is not None:
+                value = {'-': -argument, '+': argument, '~': ~argument,
+                         '!': int(not argument)}.get(operator)
+        elif node_type == 'binary_expression':
+            left = self.constant(node.child_by_field_name('left'))
+            right = self.constant(node.child_by_field_name('right'))
+            if left is not None and right is not None:
+                value = binary_value(node.child_by_field_name('operator').type, left, right)
+        elif node_type == 'sizeof_expression':
+            type_node = node.child_by_field_name('type')
+            if type_node is not None and b' '.join(self.text(type_node).split()) in CHAR_TYPES:
+                value = 1
+        if value is not None and not -INT_MAX - 1 <= value <= INT_MAX:
+            value = None  # signed overflow
+        self.values[key] = value
+        return value
+
+    def char_array(self, node):
+        """(element type, declared length or None, values) of a literal list
+        initializing a char array, else None"""
+        parent = node.parent
+        if parent is None or parent.type != 'init_declarator' or parent.parent is None:
+            return None
+        declarator = parent.child_by_field_name('declarator')
+        type_node = parent.parent.child_by_field_name('type')
+        if declarator is None or declarator.type != 'array_declarator' or type_node is None:
+            return None
+        kind = b' '.join(self.text(type_node).split())
+        if kind not in CHAR_TYPES:
+            return None
+        size = declarator.child_by_field_name('size')
+        length = None
+        if size is not None:
+            length = self.constant(size)
+            if length is None:
+                return None
+        values = []
+        for child in node.named_children:
+            if child.type == 'comment':
+                continue
+            if child.type == 'char_literal':
+                value = literal_value(self.text(child))
+                if value is None or value[0] or len(value[1]) != 1 or not isinstance(value[1][0], int):
+                    return None
+                values.append(value[1][0])
+            else:
+                value = self.constant(child)
+                if value is None:
+                    return None
+                values.append(value)
+        return kind, length, values
+
+
+def binding_keys(events):
+    """Binding key of every identifier the walk recorded, by start offset
+
+    Locals are keyed by their declaration (a redeclaration in the same
+    scope, as in both arms of an #ifdef, is the same binding), everything
+    else by ('file', name). Macro parameters are left to SourceTokens.
+    """
+    keys = {}
+    visible = {}  # name -> stack of (key, depth)
+    marks = []  # names declared in each open scope
+    for event in events:
+        kind = event[0]
+        if kind == minify.EV_ENTER:
+            marks.append([])
+            continue
+        if kind == minify.EV_EXIT:
+            for name in marks.pop():
+                visible[name].pop()
+            continue
+        _, start, _, name = event
+        if kind == minify.EV_FIXED:
+            continue
+        chain = visible.get(name)
+        if kind in (minify.EV_DECL_LOCAL, minify.EV_DECL_KEEP) and marks:
+            if kind == minify.EV_DECL_LOCAL and chain and chain[-1][1] == len(marks):
+                keys[start] = chain[-1][0]
+                continue
+            key = ('local', start) if kind == minify.EV_DECL_LOCAL else ('file', name)
+            visible.setdefault(name, []).append((key, len(marks)))
+            marks[-1].append(name)
+        elif kind == minify.EV_USE and chain:
+            key = chain[-1][0]
+        else:
+            key = ('file', name)
+        keys[start] = key
+    return keys
+
+
+class OutputTokens:
+    """Significant tokens of a parsed output, read one at a time
+
+    node is the current token's node, None past the last one.
+    """
+    def __init__(self, tree, output):
+        self.output = output
+        self.cursor = tree.walk()
+        self.node = None
+        self.done = False
+        self.settle()
+
+    def advance(self):
+        """Move past the subtree at the cursor"""
+        cursor = self.cursor
+        while not cursor.goto_next_sibling():
+            if not cursor.goto_parent():
+                self.done = True
+                return
+
+    def settle(self):
+        """Move to the first significant token at or after the cursor"""
+        cursor = self.cursor
+        output = self.output
+        while not self.done:
+            node = cursor.node
+            if node.type not in minify.ATOMIC_TYPES and cursor.goto_first_child():
+                continue
+            if (node.start_byte != node.end_byte and node.type != 'comment'
+                    and not output[node.start_byte:node.end_byte].isspace()):
+                self.node = node
+                return
+            self.advance()
+        self.node = None
+
+    def next(self):
+        self.advance()
+        self.settle()
+
+    def mark(self):
+        """The reading position, for reset()"""
+        return self.cursor.copy(), self.node, self.done
+
+    def reset(self, mark):
+        cursor, self.node, self.done = mark
+        self.cursor = cursor.copy()
+
+    def text(self):
+        node = self.node
+        return self.output[node.start_byte:node.end_byte] if node is not None else b''
+
+
+class Verifier:
+    """Compares one output with the source of the CMinifier that produced it"""
+    def __init__(self, minifier, output, tree):
+        self.source = SourceTokens(minifier)
+        self.events = minifier.events
+        self.source_bytes = minifier.source_bytes
+        self.found = OutputTokens(tree, output)
+        # Error recovery may parse the same tokens differently once their
+        # spacing changes, so types are only compared for clean sources
+        self.strict = not minifier.tree.root_node.has_error
+        self.names = {}  # binding key -> its name in the output
+        self.written_at = {}  # identifier start -> (output name, output offset)
+
+    def run(self):
+        """(reason, source offset, output offset, expected, found) of the first divergence, or None"""
+        found = self.found
+        try:
+            for item in self.source.items():
+                self.match(item)
+        except Divergence as error:
+            reason, start, expected = error.args
+            at = found.node.start_byte if found.node is not None else len(found.output)
+            return reason, start, at, expected, found.text()
+        if found.node is not None:
+            return 'extra output', len(self.source_bytes), found.node.start_byte, b'', found.text()
+        return self.check_scopes()
+
+    def match(self, item):
+        """Match one source item at the output's current token, and pass it"""
+        node_type, text, start, extra = item
+        found = self.found
+        if node_type is None:
+            self.match_group(extra)
+            return
+        if node_type == 'preproc_arg':
+            self.match_macro_body(text, start, extra)
+            return
+        node = found.node
+        if node is None:
+            raise Divergence('output ends early', start, text)
+        found_text = found.text()
+        if node_type == 'identifier':
+            if node.type != 'identifier' and (self.strict or not IDENTIFIER.fullmatch(found_text)):
+                raise Divergence(f"parses as {node.type}, not identifier", start, text)
+            self.match_name(text, start, extra, found_text, node.start_byte)
+        elif found_text != text and not same_literal(node_type, text, found_text):
+            reason = 'literal value differs' if node_type.endswith('_literal') else 'token differs'
+            raise Divergence(reason, start, text)
+        elif self.strict and node.type != node_type:
+            raise Divergence(f"parses as {node.type}, not {node_type}", start, text)
+        found.next()
+
+    def match_name(self, name, start, key, found_name, found_at):
+        """An identifier: one output name per binding, the name itself without one"""
+        if key is None:
+            if found_name != name:
+                raise Divergence('renamed without a binding', start, name)
+            return
+        written = self.names.setdefault(key, found_name)
+        if written != found_name:
+            raise Divergence('binding renamed inconsistently', start, written)
+        self.written_at[start] = (found_name, found_at)
+
+    def match_macro_body(self, text, start, parameters):
+        found = self.found
+        expected = macro_tokens(text)
+        if not expected:
+            return  # a body of comments writes nothing
+        node = found.node
+        if node is None:
+            raise Divergence('output ends early', start, text)
+        if node.type != 'preproc_arg':
+            raise Divergence(f"parses as {node.type}, not preproc_arg", start, text)
+        tokens = macro_tokens(found.text())
+        renames = {}
+        if parameters:
+            renames = {name: self.names.get(key, name) for name, key in parameters.items()}
+            if len(set(renames.values())) != len(renames):
+                raise Divergence('macro parameters renamed alike', start, text)
+        taken = set(renames.values())
+        if len(tokens) != len(expected):
+            raise Divergence('macro body differs', start, text)
+        for token, found_token in zip(expected, tokens):
+            if token in renames:
+                token = renames[token]
+            elif token in taken and IDENTIFIER.fullmatch(token):
+                raise Divergence('renamed macro parameter captures a name of the body',
+                                 start, text)
+            if found_token != token:
+                raise Divergence('macro body differs', start, text)
+        found.next()
+
+    def match_group(self, node):
+        """A subtree written token for token, or as one literal of its value"""
+        found = self.found
+        mark = found.mark()
+        try:
+            for child in node.children:
+                for item in self.source.items(child):
+                    self.match(item)
+            return
+        except Divergence:
+            found.reset(mark)
+        source = self.source
+        start = node.start_byte
+        found_node = found.node
+        if node.type in EXPRESSION_TYPES:
+            value = number_value(found.text()) if found_node is not None else None
+            if (found_node is None or found_node.type != 'number_literal'
+                    or value != (source.constant(node), ('int', False, 0, None))):
+                raise Divergence('folded value differs', start, source.text(node))
+            found.next()
+            return
+        # A string literal, or several, in place of adjacent strings or a list
+        units = []
+        while found.node is not None and found.node.type == 'string_literal':
+            value = literal_value(found.text())
+            if value is None or value[0]:
+                break
+            units.extend(value[1])
+            found.next()
+        if node.type == 'concatenated_string':
+            expected = []
+            for child in node.children:
+                if child.type == 'string_literal':
+                    value = literal_value(source.text(child))
+                    if value is None or value[0]:
+                        expected = None
+                        break
+                    expected.extend(value[1])
+            if expected != units:
+                found.reset(mark)
+                raise Divergence('merged string differs', start, source.text(node))
+            return
+        kind, length, values = source.char_array(node)
+        limit = 0xff if kind == b'unsigned char' else 0x7f
+        string = units + [0]  # with its terminating null
+        if length is None:
+            same = values == string
+        else:
+            # Both fill the array and zero the rest; the null may not fit
+            same = (len(values) <= length and len(units) <= length
+                    and values + [0] * (length - len(values)) == (string + [0] * length)[:length])
+        if not same or not all(isinstance(unit, int) and 0 <= unit <= limit for unit in units):
+            found.reset(mark)
+            raise Divergence('char array string differs', start, source.text(node))
+
+    def check_scopes(self):
+        """Replay the walk's scopes with output names: every reference must
+        find its own binding, and no scope may declare one name twice"""
+        keys = self.source.keys
+        written_at = self.written_at
+        scopes = [{}]  # output name -> key, per open block scope
+        files = {}  # output name -> file-scope key
+        for event in self.events:
+            kind = event[0]
+            if kind == minify.EV_ENTER:
+                scopes.append({})
+                continue
+            if kind == minify.EV_EXIT:
+                scopes.pop()
+                continue
+            start = event[1]
+            key = keys.get(start)
+            if key is None or start not in written_at:
+                continue
+            name, at = written_at[start]
+            if key[0] == 'file':
+                if files.setdefault(name, key) != key:
+                    return 'two file-scope names written alike', start, at, event[3], name
+            if kind in (minify.EV_DECL_LOCAL, minify.EV_DECL_KEEP) and len(scopes) > 1:
+                other = scopes[-1].get(name)
+                if other is not None and other != key:
+                    return 'two declarations of one scope written alike', start, at, event[3], name
+                scopes[-1][name] = key
+                continue
+            for scope in reversed(scopes):
+                if name in scope:
+                    if scope[name] != key:
+                        return ('reference captured by another binding', start, at,
+                                event[3], name)
+                    break
+            else:
+                if key[0] != 'file':
+                    return 'reference outside its binding', start, at, event[3], name
+        return None
+
+
+def position(text, offset):
+    """1-based (line, column) of a byte offset"""
+    prefix = bytes(text[:offset])
+    return [prefix.count(b'\n') + 1, offset - prefix.rfind(b'\n')]
+
+
+def quote(text):
+    text = bytes(text)
+    if len(text) > QUOTE_BYTES:
+        text = text[:QUOTE_BYTES] + b'...'
+    return text.decode('utf-8', 'replace')
+
+
+def first_error(node):
+    """The first ERROR or MISSING node under node, which has_error"""
+    cursor = node.walk()
+    while True:
+        node = cursor.node
+        if node.type == 'ERROR' or node.is_missing:
+            return node
+        if node.has_error and cursor.goto_first_child():
+            continue
+        while not cursor.goto_next_sibling():
+            if not cursor.goto_parent():
+                return node
+
+
+def verify(minifier, output, parser=None):
+    """None if output is equivalent to what minifier was given, else the first divergence
+
+    minifier is the CMinifier that produced output. A divergence is a dict
+    with the 'reason', the 'source' and 'output' positions as [line,
+    column], and the 'expected' and 'found' token texts.
+    """
+    source_bytes = minifier.source_bytes
+    tree = (parser or minify.get_parser()).parse(output)
+
+    def divergence(reason, start, found_at, expected, found):
+        return {'reason': reason, 'source': position(source_bytes, start),
+                'output': position(output, found_at), 'expected': quote(expected),
+                'found': quote(found)}
+
+    if not minifier.tree.root_node.has_error and tree.root_node.has_error:
+        node = first_error(tree.root_node)
+        text = output[node.start_byte:node.end_byte]
+        return divergence('syntax error in the output', 0, node.start_byte, b'', text)
+    result = Verifier(minifier, output, tree).run()
+    return divergence(*result) if result is not None else None
+
+
+def format_divergence(name, divergence):
+    """One line: where the output stops matching its source, and how"""
+    line, column = divergence['source']
+    output_line, output_column = divergence['output']
+    return (f"{name}:{line}:{column}: {divergence['reason']}: expected "
+            f"'{divergence['expected']}', found '{divergence['found']}' "
+            f"(output {output_line}:{output_column})")
+
+
+def main(argv=None):
+    argv = sys.argv[1:] if argv is None else argv
+    options = [arg for arg in argv if arg in minify.PASS_OPTIONS]
+    files = [arg for arg in argv if arg not in minify.PASS_OPTIONS]
+    if not files:
+        print("Usage: python3 verify.py [--remove-dead-code] [--compact-literals] <file.c>...",
+              file=sys.stderr)
+        return 1
+    failed = 0
+    for path in files:
+        minifier = minify.CMinifier(minify.read_source(path),
+                                    remove_dead_code='--remove-dead-code' in options,
+                                    compact_literals='--compact-literals' in options)
+        divergence = verify(minifier, minifier.minify())
+        if divergence is None:
+            print(f"{path}: ok")
+        else:
+            failed += 1
+            print(format_divergence(path, divergence))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())